@@ -0,0 +1,14 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <Eigen/Dense>
+
+template <typename T>
+using Vec = std::vector<T>;
+
+template <typename T1, typename T2>
+using Pair = std::pair<T1, T2>;
+
+using Point3d = Eigen::Vector3d;
+using Point3f = Eigen::Vector3f;
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <iostream>
+#include "Common.hpp"
+#include "PointView.hpp"
+#include "VoxelGrid.hpp"
+#include "PlaneFit.hpp"
+#include "RANSAC_plane.hpp"
+
+// Point kept for each occupied voxel
+enum class VoxelRepresentative { Centroid, FirstPoint };
+
+// One point per occupied voxel of a cloud, weighted by the number of input points it stands for.
+// FirstPoint keeps the input point with the lowest index in the voxel, Centroid their mean.
+// The reduced cloud is an owned structure-of-arrays buffer.
+template <typename Scalar = double>
+class VoxelDownsample{
+    public:
+        VoxelDownsample() = default;
+
+        VoxelDownsample(const PointView& input, double voxel_size, VoxelRepresentative mode = VoxelRepresentative::Centroid) {
+            build(input, voxel_size, mode);
+        }
+
+        void build(const PointView& input, double voxel_size, VoxelRepresentative mode = VoxelRepresentative::Centroid) {
+            VoxelGrid grid(input, voxel_size);
+            const Vec<VoxelGrid::Cell>& cells = grid.occupiedCells();
+            const Vec<size_t>& indices = grid.indices();
+
+            xs.resize(cells.size());
+            ys.resize(cells.size());
+            zs.resize(cells.size());
+            w.resize(cells.size());
+            for (size_t c = 0; c < cells.size(); c++) {
+                const VoxelGrid::Cell& cell = cells[c];
+                Point3d p = input[indices[cell.begin]];
+                if (mode == VoxelRepresentative::Centroid) {
+                    // Relative to the first point, as in PlaneScatter, to keep far-off clouds exact
+                    Point3d sum = Point3d::Zero();
+                    for (size_t i = cell.begin + 1; i < cell.end; i++) sum += input[indices[i]] - p;
+                    p += sum / static_cast<double>(cell.size());
+                }
+                xs[c] = static_cast<Scalar>(p.x());
+                ys[c] = static_cast<Scalar>(p.y());
+                zs[c] = static_cast<Scalar>(p.z());
+                w[c] = static_cast<Scalar>(cell.size());
+            }
+        }
+
+        PointView points() const { return PointView::soa(xs.data(), ys.data(), zs.data(), xs.size()); }
+
+        // Number of input points behind each point of points()
+        const Vec<Scalar>& weights() const { return w; }
+
+        size_t size() const { return xs.size(); }
+
+    private:
+        Vec<Scalar> xs, ys, zs, w;
+};
+
+// Plane RANSAC on a voxel-downsampled cloud: hypotheses are drawn and scored on one weighted
+// point per voxel (see RansacEngine::setWeights()), then the winner is refitted by least squares and
+// its inliers classified once on the full-resolution points. min_consensus counts input points.
+// Keep the voxel size near the tolerance: a much larger voxel mixes a plane with the clutter
+// next to it and pulls its representative off the plane.
+template <typename Scalar = double, typename Accumulator = double>
+class DownsampledPlaneRANSAC{
+    public:
+        using Model = PlaneModelT<Scalar>;
+
+        DownsampledPlaneRANSAC(double voxel_size, Scalar error_tolerance, int max_iterations, int min_consensus,
+                               double confidence = 0.99, VoxelRepresentative mode = VoxelRepresentative::Centroid)
+            : solver(PointView(), error_tolerance, max_iterations, min_consensus, confidence),
+              voxel_size(voxel_size), error_tolerance(error_tolerance), mode(mode) {}
+
+        // Move-only: solver holds pointers into reduced's points and weights
+        DownsampledPlaneRANSAC(const DownsampledPlaneRANSAC&) = delete;
+        DownsampledPlaneRANSAC& operator=(const DownsampledPlaneRANSAC&) = delete;
+        DownsampledPlaneRANSAC(DownsampledPlaneRANSAC&&) = default;
+        DownsampledPlaneRANSAC& operator=(DownsampledPlaneRANSAC&&) = default;
+
+        Model run(const PointView& input) {
+            inliers.clear();
+            reduced.build(input, voxel_size, mode);
+            solver.setPoints(reduced.points());
+            solver.setWeights(reduced.weights().data());
+
+            Model coarse = solver.run();
+            if (!coarse.isValid()) return Model();
+
+            // Full-resolution pass: the inliers of the coarse model feed the final refit
+            PlaneScatter<Accumulator> scatter;
+            for (size_t i = 0; i < input.size(); i++) {
+                Point3d p = input[i];
+                if (coarse.computeDistance(p.template cast<Scalar>()) >= error_tolerance) continue;
+                inliers.push_back(i);
+                scatter.add(p.template cast<Accumulator>());
+            }
+            if (inliers.size() < 3) {
+                inliers.clear();
+                std::cerr << "Downsampled RANSAC found no full-resolution consensus set." << std::endl;
+                return Model();
+            }
+
+            return PlanePolicy<Scalar, Accumulator>::fit(scatter);
+        }
+
+        // Indices into the full-resolution input of the consensus set found by the last run()
+        const Vec<size_t>& getInliers() const { return inliers; }
+
+        // The reduced cloud of the last run()
+        const VoxelDownsample<Scalar>& downsampled() const { return reduced; }
+
+        // The estimator run on the reduced cloud, e.g. to enable LO or a robust loss
+        PlaneRANSAC<Scalar, Accumulator>& estimator() { return solver; }
+
+    private:
+        PlaneRANSAC<Scalar, Accumulator> solver;
+        VoxelDownsample<Scalar> reduced;
+        double voxel_size;
+        Scalar error_tolerance;
+        VoxelRepresentative mode;
+        Vec<size_t> inliers;
+};
+
+#ifdef RANSAC_PREBUILT
+extern template class DownsampledPlaneRANSAC<double, double>;
+#endif
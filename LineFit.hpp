@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+
+// Streaming least-squares sums of a 2D point set for the line y = m x + b: sumX, sumY, sumX2 and
+// sumXY, enough to recover the fit without keeping the points. Points can be removed as well as
+// added. Sums are taken relative to the first point added to limit cancellation, e.g. on
+// timestamps far from zero. Scalar is the accumulation precision.
+template <typename Scalar = double>
+class LineMoments{
+    public:
+        void add(Scalar x, Scalar y){
+            if (n == 0) {
+                origin_x = x;
+                origin_y = y;
+            }
+            Scalar dx = x - origin_x, dy = y - origin_y;
+            sumX += dx;
+            sumY += dy;
+            sumX2 += dx * dx;
+            sumXY += dx * dy;
+            n++;
+        }
+
+        void remove(Scalar x, Scalar y){
+            Scalar dx = x - origin_x, dy = y - origin_y;
+            sumX -= dx;
+            sumY -= dy;
+            sumX2 -= dx * dx;
+            sumXY -= dx * dy;
+            n--;
+        }
+
+        void clear(){
+            n = 0;
+            sumX = sumY = sumX2 = sumXY = 0;
+        }
+
+        size_t count() const { return n; }
+
+        // False with fewer than two distinct x, where the slope is undefined
+        bool valid() const { return n >= 2 && denominator() != 0; }
+
+        Scalar slope() const { return (n * sumXY - sumX * sumY) / denominator(); }
+
+        Scalar intercept() const {
+            Scalar m = slope();
+            return origin_y + (sumY - m * sumX) / n - m * origin_x;
+        }
+
+    private:
+        size_t n = 0;
+        Scalar origin_x = 0, origin_y = 0;
+        Scalar sumX = 0, sumY = 0, sumX2 = 0, sumXY = 0;
+
+        Scalar denominator() const { return n * sumX2 - sumX * sumX; }
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <utility>
+#include "Common.hpp"
+#include "PointView.hpp"
+#include "RANSAC_plane.hpp"
+
+// Sequential RANSAC: finds planes one after another, moving each plane's inliers to the front
+// of the points that are still unassigned. The cloud is copied once into an owned
+// structure-of-arrays buffer; after that every round runs on a contiguous view of the remaining
+// suffix and partitions it in place, so rounds allocate nothing.
+template <typename Scalar = double, typename Accumulator = double>
+class MultiPlaneExtractor{
+    public:
+        using Model = PlaneModelT<Scalar>;
+
+        // Plane k owns positions [begin, end) of points() / originalIndices()
+        struct Segment{
+            Model model;
+            size_t begin;
+            size_t end;
+
+            size_t size() const { return end - begin; }
+        };
+
+        MultiPlaneExtractor(Scalar error_tolerance, int max_iterations, size_t min_plane_size, size_t max_planes,
+                            double confidence = 0.99)
+            : solver(PointView(), error_tolerance, max_iterations, static_cast<int>(min_plane_size), confidence),
+              min_plane_size(std::max<size_t>(3, min_plane_size)), max_planes(max_planes) {}
+
+        // Move-only: solver views xs, ys and zs, which a copy would leave pointing at the original
+        MultiPlaneExtractor(const MultiPlaneExtractor&) = delete;
+        MultiPlaneExtractor& operator=(const MultiPlaneExtractor&) = delete;
+        MultiPlaneExtractor(MultiPlaneExtractor&&) = default;
+        MultiPlaneExtractor& operator=(MultiPlaneExtractor&&) = default;
+
+        // Extracts up to max_planes planes with at least min_plane_size inliers each
+        const Vec<Segment>& extract(const PointView& input) {
+            load(input);
+            segments.clear();
+
+            size_t begin = 0;
+            const size_t n = xs.size();
+            while (segments.size() < max_planes && n - begin >= min_plane_size) {
+                solver.setPoints(PointView::soa(xs.data() + begin, ys.data() + begin, zs.data() + begin, n - begin));
+                Model plane = solver.run();
+                if (!plane.isValid()) break;
+
+                const Vec<size_t>& inliers = solver.getInliers();
+                if (inliers.size() < min_plane_size) break;
+
+                partition(begin, inliers);
+                segments.push_back({plane, begin, begin + inliers.size()});
+                begin += inliers.size();
+            }
+            return segments;
+        }
+
+        const Vec<Segment>& getSegments() const { return segments; }
+
+        // Points in extraction order: all planes first, then the unassigned remainder
+        PointView points() const { return PointView::soa(xs.data(), ys.data(), zs.data(), xs.size()); }
+
+        // Index into the input cloud of every position in points()
+        const Vec<size_t>& originalIndices() const { return order; }
+
+        // First position of the points that belong to no plane
+        size_t remainderBegin() const { return segments.empty() ? 0 : segments.back().end; }
+
+        // The per-round estimator, e.g. to enable SPRT or partitioned scoring
+        PlaneRANSAC<Scalar, Accumulator>& estimator() { return solver; }
+
+    private:
+        PlaneRANSAC<Scalar, Accumulator> solver;
+        size_t min_plane_size;
+        size_t max_planes;
+
+        Vec<Scalar> xs, ys, zs;
+        Vec<size_t> order;
+        Vec<Segment> segments;
+
+        void load(const PointView& input) {
+            const size_t n = input.size();
+            xs.resize(n);
+            ys.resize(n);
+            zs.resize(n);
+            order.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                xs[i] = static_cast<Scalar>(input.x(i));
+                ys[i] = static_cast<Scalar>(input.y(i));
+                zs[i] = static_cast<Scalar>(input.z(i));
+                order[i] = i;
+            }
+        }
+
+        // Moves the (ascending, range-relative) inliers to the front of [begin, n). Positions
+        // skipped over so far only hold outliers, so swapping them forward keeps the partition valid.
+        void partition(size_t begin, const Vec<size_t>& inliers) {
+            size_t write = begin;
+            for (size_t idx : inliers) {
+                size_t read = begin + idx;
+                std::swap(xs[write], xs[read]);
+                std::swap(ys[write], ys[read]);
+                std::swap(zs[write], zs[read]);
+                std::swap(order[write], order[read]);
+                write++;
+            }
+        }
+};
+
+#ifdef RANSAC_PREBUILT
+extern template class MultiPlaneExtractor<double, double>;
+#endif
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "Common.hpp"
+#include "PointView.hpp"
+#include "PlaneKernels.hpp"
+#include "VoxelGrid.hpp"
+
+// Octree over a point cloud for consensus counting with spatial culling. The points are copied
+// once, in Morton order, into an owned structure-of-arrays buffer, so every node is a contiguous
+// range of points(); each node keeps the tight bounding box of its points. A plane hypothesis
+// then accepts or rejects whole nodes with one box-plane test and only scans the leaves that
+// straddle the tolerance band, with the SIMD kernels of countPlaneInliers().
+template <typename Scalar = double>
+class PointOctree{
+    public:
+        PointOctree() = default;
+
+        // Nodes with at most leaf_size points are not split further
+        PointOctree(const PointView& input, size_t leaf_size = 128) { build(input, leaf_size); }
+
+        // Rebuilds the tree over new points, e.g. the next frame of a sequence, reusing every buffer
+        void build(const PointView& input, size_t leaf_size = 128) {
+            this->leaf_size = std::max<size_t>(1, leaf_size);
+            const size_t n = input.size();
+            nodes.clear();
+            xs.resize(n);
+            ys.resize(n);
+            zs.resize(n);
+            order.resize(n);
+            if (n == 0) return;
+
+            Point3d lo = input[0], hi = input[0];
+            for (size_t i = 1; i < n; i++) {
+                Point3d p = input[i];
+                lo = lo.cwiseMin(p);
+                hi = hi.cwiseMax(p);
+            }
+
+            // Morton codes on a cube grid of 2^21 cells per axis spanning the bounding box
+            const double extent = std::max((hi - lo).maxCoeff(), 1e-12);
+            const double scale = static_cast<double>((1 << kLevels) - 1) / extent;
+            keyed.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                Point3d q = (input[i] - lo) * scale;
+                keyed[i] = {spread(static_cast<uint64_t>(q.x())) | (spread(static_cast<uint64_t>(q.y())) << 1) |
+                            (spread(static_cast<uint64_t>(q.z())) << 2), i};
+            }
+            radixSortByKey(keyed, scratch);
+
+            for (size_t i = 0; i < n; i++) {
+                Point3d p = input[keyed[i].second];
+                xs[i] = static_cast<Scalar>(p.x());
+                ys[i] = static_cast<Scalar>(p.y());
+                zs[i] = static_cast<Scalar>(p.z());
+                order[i] = keyed[i].second;
+            }
+
+            nodes.push_back(Node());
+            buildNode(0, 0, n, 0);
+        }
+
+        bool empty() const { return nodes.empty(); }
+        size_t size() const { return xs.size(); }
+        size_t nodeCount() const { return nodes.size(); }
+
+        // Points in Morton order
+        PointView points() const { return PointView::soa(xs.data(), ys.data(), zs.data(), xs.size()); }
+
+        // Index into the input cloud of every position in points()
+        const Vec<size_t>& originalIndices() const { return order; }
+
+        // Same count as countPlaneInliers() over the whole cloud, except for points within rounding
+        // of the band edge, which its vector and scalar paths can already classify differently.
+        // Nodes whose box lies entirely outside the band |ax + by + cz + d| < tolerance are skipped,
+        // nodes entirely inside it counted whole, and straddling leaves scanned; scanned, if given,
+        // receives the number of points read. Boxes within a few ulps of the edge count as straddling.
+        size_t countPlaneInliers(Scalar a, Scalar b, Scalar c, Scalar d, Scalar tolerance, size_t* scanned = nullptr) const {
+            if (nodes.empty()) return 0;
+
+            const PointView view = points();
+            const Scalar aa = std::abs(a), ab = std::abs(b), ac = std::abs(c), ad = std::abs(d);
+            const Scalar ulps = 8 * std::numeric_limits<Scalar>::epsilon();
+
+            uint32_t stack[kStackSize];
+            size_t top = 0;
+            stack[top++] = 0;
+
+            size_t count = 0, read = 0;
+            while (top > 0) {
+                const Node& node = nodes[stack[--top]];
+                const Scalar cx = (node.lo[0] + node.hi[0]) / 2, hx = (node.hi[0] - node.lo[0]) / 2;
+                const Scalar cy = (node.lo[1] + node.hi[1]) / 2, hy = (node.hi[1] - node.lo[1]) / 2;
+                const Scalar cz = (node.lo[2] + node.hi[2]) / 2, hz = (node.hi[2] - node.lo[2]) / 2;
+                const Scalar centre = std::abs(a * cx + b * cy + c * cz + d);
+                const Scalar reach = aa * hx + ab * hy + ac * hz;
+                const Scalar slack = ulps * (aa * std::abs(cx) + ab * std::abs(cy) + ac * std::abs(cz) + ad + reach);
+
+                if (centre - reach >= tolerance + slack) continue;
+                if (centre + reach < tolerance - slack) {
+                    count += node.end - node.begin;
+                    continue;
+                }
+                if (node.child_count == 0) {
+                    count += ::countPlaneInliers<Scalar>(view, node.begin, node.end - node.begin, a, b, c, d, tolerance);
+                    read += node.end - node.begin;
+                    continue;
+                }
+                for (uint32_t k = 0; k < node.child_count; k++) stack[top++] = node.first_child + k;
+            }
+
+            if (scanned) *scanned = read;
+            return count;
+        }
+
+    private:
+        // Corners of the tight box, exact coordinates of the points; children stored contiguously
+        struct Node{
+            Scalar lo[3] = {0, 0, 0};
+            Scalar hi[3] = {0, 0, 0};
+            size_t begin = 0, end = 0;
+            uint32_t first_child = 0;
+            uint32_t child_count = 0;
+        };
+
+        static constexpr int kLevels = 21;
+        static constexpr size_t kStackSize = 7 * kLevels + 8;    // depth-first, at most 7 siblings waiting per level
+
+        size_t leaf_size = 128;
+        Vec<Scalar> xs, ys, zs;
+        Vec<size_t> order;
+        Vec<Pair<uint64_t, size_t>> keyed, scratch;    // Morton code of every point, by position once sorted
+        Vec<Node> nodes;
+
+        // Spreads the low 21 bits of v three bits apart
+        static uint64_t spread(uint64_t v) {
+            v &= 0x1fffff;
+            v = (v | v << 32) & 0x1f00000000ffffULL;
+            v = (v | v << 16) & 0x1f0000ff0000ffULL;
+            v = (v | v << 8)  & 0x100f00f00f00f00fULL;
+            v = (v | v << 4)  & 0x10c30c30c30c30c3ULL;
+            v = (v | v << 2)  & 0x1249249249249249ULL;
+            return v;
+        }
+
+        // Fills nodes[index] with points [begin, end), whose codes agree above the octant bits of
+        // this level, and builds its children
+        void buildNode(size_t index, size_t begin, size_t end, int level) {
+            nodes[index].begin = begin;
+            nodes[index].end = end;
+
+            if (end - begin > leaf_size && level < kLevels) {
+                const int shift = 3 * (kLevels - 1 - level);
+                const uint32_t first = static_cast<uint32_t>(nodes.size());
+                size_t bounds[9] = {begin};    // at most 8 octants
+                uint32_t children = 0;
+                for (size_t i = begin + 1; i < end; i++) {
+                    if ((keyed[i].first >> shift & 7) != (keyed[i - 1].first >> shift & 7)) bounds[++children] = i;
+                }
+                bounds[++children] = end;
+
+                // A single octant just narrows the range, so descend without a new node
+                if (children == 1) {
+                    buildNode(index, begin, end, level + 1);
+                    return;
+                }
+
+                nodes.resize(nodes.size() + children);
+                nodes[index].first_child = first;
+                nodes[index].child_count = children;
+                for (uint32_t k = 0; k < children; k++) buildNode(first + k, bounds[k], bounds[k + 1], level + 1);
+            }
+
+            // Tight box, from the children's boxes or from the points of a leaf
+            Node& node = nodes[index];
+            if (node.child_count > 0) {
+                const Node& first = nodes[node.first_child];
+                std::copy(first.lo, first.lo + 3, node.lo);
+                std::copy(first.hi, first.hi + 3, node.hi);
+                for (uint32_t k = 1; k < node.child_count; k++) {
+                    const Node& child = nodes[node.first_child + k];
+                    for (int axis = 0; axis < 3; axis++) {
+                        node.lo[axis] = std::min(node.lo[axis], child.lo[axis]);
+                        node.hi[axis] = std::max(node.hi[axis], child.hi[axis]);
+                    }
+                }
+            } else {
+                node.lo[0] = node.hi[0] = xs[begin];
+                node.lo[1] = node.hi[1] = ys[begin];
+                node.lo[2] = node.hi[2] = zs[begin];
+                for (size_t i = begin + 1; i < end; i++) {
+                    node.lo[0] = std::min(node.lo[0], xs[i]);
+                    node.hi[0] = std::max(node.hi[0], xs[i]);
+                    node.lo[1] = std::min(node.lo[1], ys[i]);
+                    node.hi[1] = std::max(node.hi[1], ys[i]);
+                    node.lo[2] = std::min(node.lo[2], zs[i]);
+                    node.hi[2] = std::max(node.hi[2], zs[i]);
+                }
+            }
+        }
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <Eigen/Dense>
+
+// Streaming first and second moments of a 3D point set, enough to recover the
+// least-squares plane without keeping the points. Moments are taken relative to
+// the first point added to limit cancellation on clouds far from the origin.
+// Scalar is the accumulation precision; double is recommended even for float clouds.
+template <typename Scalar = double>
+class PlaneScatter{
+    public:
+        using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+        using Matrix3 = Eigen::Matrix<Scalar, 3, 3>;
+
+        void add(const Vector3 &pt){
+            if (n == 0) origin = pt;
+            Vector3 q = pt - origin;
+            sum += q;
+            sum_sq.noalias() += q * q.transpose();
+            n++;
+        }
+
+        void remove(const Vector3 &pt){
+            Vector3 q = pt - origin;
+            sum -= q;
+            sum_sq.noalias() -= q * q.transpose();
+            n--;
+        }
+
+        void clear(){
+            n = 0;
+            sum.setZero();
+            sum_sq.setZero();
+        }
+
+        size_t count() const { return n; }
+
+        Vector3 centroid() const { return origin + sum / static_cast<Scalar>(n); }
+
+        Matrix3 covariance() const {
+            Vector3 mean = sum / static_cast<Scalar>(n);
+            return sum_sq / static_cast<Scalar>(n) - mean * mean.transpose();
+        }
+
+        // Unit normal of the best-fit plane: eigenvector of the smallest eigenvalue
+        Vector3 normal() const {
+            Eigen::SelfAdjointEigenSolver<Matrix3> solver(covariance());
+            return solver.eigenvectors().col(0);
+        }
+
+    private:
+        size_t n = 0;
+        Vector3 origin = Vector3::Zero();
+        Vector3 sum = Vector3::Zero();
+        Matrix3 sum_sq = Matrix3::Zero();
+};
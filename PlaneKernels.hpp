@@ -0,0 +1,442 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "PointView.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define RANSAC_X86_DISPATCH 1
+#include <immintrin.h>
+#else
+#define RANSAC_X86_DISPATCH 0
+#endif
+
+// Batch point-to-plane inlier counting. The plane (a, b, c, d) is expected to have a unit
+// normal, so |ax + by + cz + d| is the distance. Validity of the plane is checked by the
+// caller, once per hypothesis.
+//
+// Every kernel reads coordinates of type T (float or double) straight from caller memory:
+// x, y and z point at the first point's coordinates and consecutive points are `stride` bytes
+// apart. Contiguous arrays (stride == sizeof(T)) use plain vector loads, anything else
+// (array-of-structs, interleaved records) uses gathers. Conversions between the storage type
+// and the arithmetic type happen in registers.
+
+template <typename Scalar>
+using PlaneInlierKernel = size_t (*)(const unsigned char *x, const unsigned char *y, const unsigned char *z,
+                                     size_t stride, size_t n, Scalar a, Scalar b, Scalar c, Scalar d, Scalar tolerance);
+
+template <typename T, typename Scalar = double>
+inline size_t countPlaneInliersScalar(const unsigned char *x, const unsigned char *y, const unsigned char *z,
+                                      size_t stride, size_t n, Scalar a, Scalar b, Scalar c, Scalar d, Scalar tolerance){
+    size_t count = 0;
+    for (size_t i = 0, offset = 0; i < n; i++, offset += stride) {
+        T px, py, pz;
+        std::memcpy(&px, x + offset, sizeof(T));
+        std::memcpy(&py, y + offset, sizeof(T));
+        std::memcpy(&pz, z + offset, sizeof(T));
+        count += std::abs(a * static_cast<Scalar>(px) + b * static_cast<Scalar>(py) + c * static_cast<Scalar>(pz) + d) < tolerance;
+    }
+    return count;
+}
+
+#if RANSAC_X86_DISPATCH
+
+template <typename T>
+__attribute__((target("avx2")))
+inline __m256d loadLanesAVX2(const unsigned char *p, size_t stride, __m256i offsets){
+    if (stride == sizeof(T)) {
+        if constexpr (sizeof(T) == sizeof(double)) return _mm256_loadu_pd(reinterpret_cast<const double*>(p));
+        else return _mm256_cvtps_pd(_mm_loadu_ps(reinterpret_cast<const float*>(p)));
+    }
+    if constexpr (sizeof(T) == sizeof(double)) return _mm256_i64gather_pd(reinterpret_cast<const double*>(p), offsets, 1);
+    else return _mm256_cvtps_pd(_mm256_i64gather_ps(reinterpret_cast<const float*>(p), offsets, 1));
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+inline size_t countPlaneInliersAVX2(const unsigned char *x, const unsigned char *y, const unsigned char *z,
+                                    size_t stride, size_t n, double a, double b, double c, double d, double tolerance){
+    const __m256d va = _mm256_set1_pd(a), vb = _mm256_set1_pd(b);
+    const __m256d vc = _mm256_set1_pd(c), vd = _mm256_set1_pd(d);
+    const __m256d vtol = _mm256_set1_pd(tolerance);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const long long s = static_cast<long long>(stride);
+    const __m256i offsets = _mm256_set_epi64x(3 * s, 2 * s, s, 0);
+
+    size_t count = 0, i = 0, offset = 0;
+    for (; i + 4 <= n; i += 4, offset += 4 * stride) {
+        __m256d dist = _mm256_add_pd(_mm256_mul_pd(va, loadLanesAVX2<T>(x + offset, stride, offsets)),
+                                     _mm256_mul_pd(vb, loadLanesAVX2<T>(y + offset, stride, offsets)));
+        dist = _mm256_add_pd(dist, _mm256_mul_pd(vc, loadLanesAVX2<T>(z + offset, stride, offsets)));
+        dist = _mm256_andnot_pd(sign, _mm256_add_pd(dist, vd));
+        count += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(dist, vtol, _CMP_LT_OQ)));
+    }
+    return count + countPlaneInliersScalar<T, double>(x + offset, y + offset, z + offset, stride, n - i, a, b, c, d, tolerance);
+}
+
+template <typename T>
+__attribute__((target("avx512f")))
+inline __m512d loadLanesAVX512(const unsigned char *p, size_t stride, __m512i offsets){
+    if (stride == sizeof(T)) {
+        if constexpr (sizeof(T) == sizeof(double)) return _mm512_loadu_pd(p);
+        else return _mm512_cvtps_pd(_mm256_loadu_ps(reinterpret_cast<const float*>(p)));
+    }
+    if constexpr (sizeof(T) == sizeof(double)) return _mm512_i64gather_pd(offsets, p, 1);
+    else return _mm512_cvtps_pd(_mm512_i64gather_ps(offsets, p, 1));
+}
+
+template <typename T>
+__attribute__((target("avx512f")))
+inline size_t countPlaneInliersAVX512(const unsigned char *x, const unsigned char *y, const unsigned char *z,
+                                      size_t stride, size_t n, double a, double b, double c, double d, double tolerance){
+    const __m512d va = _mm512_set1_pd(a), vb = _mm512_set1_pd(b);
+    const __m512d vc = _mm512_set1_pd(c), vd = _mm512_set1_pd(d);
+    const __m512d vtol = _mm512_set1_pd(tolerance);
+    const long long s = static_cast<long long>(stride);
+    const __m512i offsets = _mm512_set_epi64(7 * s, 6 * s, 5 * s, 4 * s, 3 * s, 2 * s, s, 0);
+
+    size_t count = 0, i = 0, offset = 0;
+    for (; i + 8 <= n; i += 8, offset += 8 * stride) {
+        __m512d dist = _mm512_add_pd(_mm512_mul_pd(va, loadLanesAVX512<T>(x + offset, stride, offsets)),
+                                     _mm512_mul_pd(vb, loadLanesAVX512<T>(y + offset, stride, offsets)));
+        dist = _mm512_add_pd(dist, _mm512_mul_pd(vc, loadLanesAVX512<T>(z + offset, stride, offsets)));
+        dist = _mm512_abs_pd(_mm512_add_pd(dist, vd));
+        count += __builtin_popcount(static_cast<unsigned int>(_mm512_cmp_pd_mask(dist, vtol, _CMP_LT_OQ)));
+    }
+    return count + countPlaneInliersScalar<T, double>(x + offset, y + offset, z + offset, stride, n - i, a, b, c, d, tolerance);
+}
+
+template <typename T>
+__attribute__((target("avx2")))
+inline __m256 loadLanesAVX2f(const unsigned char *p, size_t stride, __m256i offsets32, __m256i offsets64){
+    if constexpr (sizeof(T) == sizeof(float)) {
+        if (stride == sizeof(float)) return _mm256_loadu_ps(reinterpret_cast<const float*>(p));
+        return _mm256_i32gather_ps(reinterpret_cast<const float*>(p), offsets32, 1);
+    } else {
+        __m128 lo = _mm256_cvtpd_ps(loadLanesAVX2<double>(p, stride, offsets64));
+        __m128 hi = _mm256_cvtpd_ps(loadLanesAVX2<double>(p + 4 * stride, stride, offsets64));
+        return _mm256_set_m128(hi, lo);
+    }
+}
+
+// Single-precision arithmetic: 8 lanes per AVX2 register
+template <typename T>
+__attribute__((target("avx2")))
+inline size_t countPlaneInliersAVX2f(const unsigned char *x, const unsigned char *y, const unsigned char *z,
+                                     size_t stride, size_t n, float a, float b, float c, float d, float tolerance){
+    const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+    const __m256 vc = _mm256_set1_ps(c), vd = _mm256_set1_ps(d);
+    const __m256 vtol = _mm256_set1_ps(tolerance);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const int s32 = static_cast<int>(stride);
+    const long long s64 = static_cast<long long>(stride);
+    const __m256i offsets32 = _mm256_set_epi32(7 * s32, 6 * s32, 5 * s32, 4 * s32, 3 * s32, 2 * s32, s32, 0);
+    const __m256i offsets64 = _mm256_set_epi64x(3 * s64, 2 * s64, s64, 0);
+
+    size_t count = 0, i = 0, offset = 0;
+    for (; i + 8 <= n; i += 8, offset += 8 * stride) {
+        __m256 dist = _mm256_add_ps(_mm256_mul_ps(va, loadLanesAVX2f<T>(x + offset, stride, offsets32, offsets64)),
+                                    _mm256_mul_ps(vb, loadLanesAVX2f<T>(y + offset, stride, offsets32, offsets64)));
+        dist = _mm256_add_ps(dist, _mm256_mul_ps(vc, loadLanesAVX2f<T>(z + offset, stride, offsets32, offsets64)));
+        dist = _mm256_andnot_ps(sign, _mm256_add_ps(dist, vd));
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(dist, vtol, _CMP_LT_OQ)));
+    }
+    return count + countPlaneInliersScalar<T, float>(x + offset, y + offset, z + offset, stride, n - i, a, b, c, d, tolerance);
+}
+
+template <typename T>
+__attribute__((target("avx512f")))
+inline __m512 loadLanesAVX512f(const unsigned char *p, size_t stride, __m512i offsets32, __m512i offsets64){
+    if constexpr (sizeof(T) == sizeof(float)) {
+        if (stride == sizeof(float)) return _mm512_loadu_ps(p);
+        return _mm512_i32gather_ps(offsets32, p, 1);
+    } else {
+        __m256 lo = _mm512_cvtpd_ps(loadLanesAVX512<double>(p, stride, offsets64));
+        __m256 hi = _mm512_cvtpd_ps(loadLanesAVX512<double>(p + 8 * stride, stride, offsets64));
+        __m512d joined = _mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(lo)), _mm256_castps_pd(hi), 1);
+        return _mm512_castpd_ps(joined);
+    }
+}
+
+// Single-precision arithmetic: 16 lanes per AVX-512 register
+template <typename T>
+__attribute__((target("avx512f")))
+inline size_t countPlaneInliersAVX512f(const unsigned char *x, const unsigned char *y, const unsigned char *z,
+                                       size_t stride, size_t n, float a, float b, float c, float d, float tolerance){
+    const __m512 va = _mm512_set1_ps(a), vb = _mm512_set1_ps(b);
+    const __m512 vc = _mm512_set1_ps(c), vd = _mm512_set1_ps(d);
+    const __m512 vtol = _mm512_set1_ps(tolerance);
+    const int s32 = static_cast<int>(stride);
+    const long long s64 = static_cast<long long>(stride);
+    const __m512i offsets32 = _mm512_set_epi32(15 * s32, 14 * s32, 13 * s32, 12 * s32, 11 * s32, 10 * s32, 9 * s32, 8 * s32,
+                                               7 * s32, 6 * s32, 5 * s32, 4 * s32, 3 * s32, 2 * s32, s32, 0);
+    const __m512i offsets64 = _mm512_set_epi64(7 * s64, 6 * s64, 5 * s64, 4 * s64, 3 * s64, 2 * s64, s64, 0);
+
+    size_t count = 0, i = 0, offset = 0;
+    for (; i + 16 <= n; i += 16, offset += 16 * stride) {
+        __m512 dist = _mm512_add_ps(_mm512_mul_ps(va, loadLanesAVX512f<T>(x + offset, stride, offsets32, offsets64)),
+                                    _mm512_mul_ps(vb, loadLanesAVX512f<T>(y + offset, stride, offsets32, offsets64)));
+        dist = _mm512_add_ps(dist, _mm512_mul_ps(vc, loadLanesAVX512f<T>(z + offset, stride, offsets32, offsets64)));
+        dist = _mm512_abs_ps(_mm512_add_ps(dist, vd));
+        count += __builtin_popcount(static_cast<unsigned int>(_mm512_cmp_ps_mask(dist, vtol, _CMP_LT_OQ)));
+    }
+    return count + countPlaneInliersScalar<T, float>(x + offset, y + offset, z + offset, stride, n - i, a, b, c, d, tolerance);
+}
+
+#endif
+
+// Picks the widest kernel the running CPU supports for coordinates stored as T and
+// arithmetic in Scalar
+template <typename T, typename Scalar>
+inline PlaneInlierKernel<Scalar> selectPlaneInlierKernel(const char **name = nullptr){
+#if RANSAC_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        if (name) *name = "avx512";
+        if constexpr (std::is_same<Scalar, float>::value) return countPlaneInliersAVX512f<T>;
+        else return countPlaneInliersAVX512<T>;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        if (name) *name = "avx2";
+        if constexpr (std::is_same<Scalar, float>::value) return countPlaneInliersAVX2f<T>;
+        else return countPlaneInliersAVX2<T>;
+    }
+#endif
+    if (name) *name = "scalar";
+    return countPlaneInliersScalar<T, Scalar>;
+}
+
+// Counts inliers among points [begin, begin + n) of a view, whatever its layout, in Scalar
+// arithmetic.
+// A 2D view has z = 0, so its c term is dropped and the kernel reads x in place of z.
+template <typename Scalar>
+inline size_t countPlaneInliers(const PointView &points, size_t begin, size_t n,
+                                Scalar a, Scalar b, Scalar c, Scalar d, Scalar tolerance){
+    static const PlaneInlierKernel<Scalar> kernel64 = selectPlaneInlierKernel<double, Scalar>();
+    static const PlaneInlierKernel<Scalar> kernel32 = selectPlaneInlierKernel<float, Scalar>();
+
+    const size_t offset = begin * points.byteStride();
+    const unsigned char *z = points.zBytes() ? points.zBytes() : points.xBytes();
+    if (!points.zBytes()) c = 0;
+    PlaneInlierKernel<Scalar> kernel = points.scalarType() == ScalarType::Float32 ? kernel32 : kernel64;
+    return kernel(points.xBytes() + offset, points.yBytes() + offset, z + offset,
+                  points.byteStride(), n, a, b, c, d, tolerance);
+}
+
+// Batched scoring: k planes against n points is the (k x 4) * (4 x n) product of the packed
+// plane coefficients with homogeneous points, followed by a threshold count per row. The points
+// are walked in tiles small enough to stay in L1 and every plane of the batch is scored on a tile
+// before moving on, so each point is read from memory once per batch instead of once per plane.
+// Tile kernels read contiguous Scalar arrays and keep four planes in flight per loaded vector
+// of points. planes holds k rows of (a, b, c, d); counts[h] is incremented.
+
+template <typename Scalar>
+using PlaneTileKernel = void (*)(const Scalar *x, const Scalar *y, const Scalar *z, size_t n,
+                                 const Scalar *planes, size_t k, Scalar tolerance, size_t *counts);
+
+constexpr size_t kPlaneTilePoints = 512;
+
+template <typename Scalar>
+inline void countPlaneInliersTileScalar(const Scalar *x, const Scalar *y, const Scalar *z, size_t n,
+                                        const Scalar *planes, size_t k, Scalar tolerance, size_t *counts){
+    for (size_t h = 0; h < k; h++) {
+        const Scalar *p = planes + 4 * h;
+        size_t count = 0;
+        for (size_t i = 0; i < n; i++) count += std::abs(p[0] * x[i] + p[1] * y[i] + p[2] * z[i] + p[3]) < tolerance;
+        counts[h] += count;
+    }
+}
+
+#if RANSAC_X86_DISPATCH
+
+__attribute__((target("avx2")))
+inline void countPlaneInliersTileAVX2(const double *x, const double *y, const double *z, size_t n,
+                                      const double *planes, size_t k, double tolerance, size_t *counts){
+    const __m256d vtol = _mm256_set1_pd(tolerance);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const size_t full = n & ~size_t(3);
+
+    size_t h = 0;
+    for (; h + 4 <= k; h += 4) {
+        const double *p = planes + 4 * h;
+        __m256d coeff[16];
+        for (int j = 0; j < 16; j++) coeff[j] = _mm256_set1_pd(p[j]);
+
+        size_t hits[4] = {0, 0, 0, 0};
+        for (size_t i = 0; i < full; i += 4) {
+            const __m256d px = _mm256_loadu_pd(x + i), py = _mm256_loadu_pd(y + i), pz = _mm256_loadu_pd(z + i);
+            for (int q = 0; q < 4; q++) {
+                __m256d dist = _mm256_add_pd(_mm256_mul_pd(coeff[4 * q], px), _mm256_mul_pd(coeff[4 * q + 1], py));
+                dist = _mm256_add_pd(dist, _mm256_mul_pd(coeff[4 * q + 2], pz));
+                dist = _mm256_andnot_pd(sign, _mm256_add_pd(dist, coeff[4 * q + 3]));
+                hits[q] += __builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(dist, vtol, _CMP_LT_OQ)));
+            }
+        }
+        for (int q = 0; q < 4; q++) counts[h + q] += hits[q];
+        countPlaneInliersTileScalar<double>(x + full, y + full, z + full, n - full, p, 4, tolerance, counts + h);
+    }
+    countPlaneInliersTileScalar<double>(x, y, z, n, planes + 4 * h, k - h, tolerance, counts + h);
+}
+
+__attribute__((target("avx2")))
+inline void countPlaneInliersTileAVX2f(const float *x, const float *y, const float *z, size_t n,
+                                       const float *planes, size_t k, float tolerance, size_t *counts){
+    const __m256 vtol = _mm256_set1_ps(tolerance);
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const size_t full = n & ~size_t(7);
+
+    size_t h = 0;
+    for (; h + 4 <= k; h += 4) {
+        const float *p = planes + 4 * h;
+        __m256 coeff[16];
+        for (int j = 0; j < 16; j++) coeff[j] = _mm256_set1_ps(p[j]);
+
+        size_t hits[4] = {0, 0, 0, 0};
+        for (size_t i = 0; i < full; i += 8) {
+            const __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+            for (int q = 0; q < 4; q++) {
+                __m256 dist = _mm256_add_ps(_mm256_mul_ps(coeff[4 * q], px), _mm256_mul_ps(coeff[4 * q + 1], py));
+                dist = _mm256_add_ps(dist, _mm256_mul_ps(coeff[4 * q + 2], pz));
+                dist = _mm256_andnot_ps(sign, _mm256_add_ps(dist, coeff[4 * q + 3]));
+                hits[q] += __builtin_popcount(_mm256_movemask_ps(_mm256_cmp_ps(dist, vtol, _CMP_LT_OQ)));
+            }
+        }
+        for (int q = 0; q < 4; q++) counts[h + q] += hits[q];
+        countPlaneInliersTileScalar<float>(x + full, y + full, z + full, n - full, p, 4, tolerance, counts + h);
+    }
+    countPlaneInliersTileScalar<float>(x, y, z, n, planes + 4 * h, k - h, tolerance, counts + h);
+}
+
+__attribute__((target("avx512f")))
+inline void countPlaneInliersTileAVX512(const double *x, const double *y, const double *z, size_t n,
+                                        const double *planes, size_t k, double tolerance, size_t *counts){
+    const __m512d vtol = _mm512_set1_pd(tolerance);
+    const size_t full = n & ~size_t(7);
+
+    size_t h = 0;
+    for (; h + 4 <= k; h += 4) {
+        const double *p = planes + 4 * h;
+        __m512d coeff[16];
+        for (int j = 0; j < 16; j++) coeff[j] = _mm512_set1_pd(p[j]);
+
+        size_t hits[4] = {0, 0, 0, 0};
+        for (size_t i = 0; i < full; i += 8) {
+            const __m512d px = _mm512_loadu_pd(x + i), py = _mm512_loadu_pd(y + i), pz = _mm512_loadu_pd(z + i);
+            for (int q = 0; q < 4; q++) {
+                __m512d dist = _mm512_add_pd(_mm512_mul_pd(coeff[4 * q], px), _mm512_mul_pd(coeff[4 * q + 1], py));
+                dist = _mm512_add_pd(dist, _mm512_mul_pd(coeff[4 * q + 2], pz));
+                dist = _mm512_abs_pd(_mm512_add_pd(dist, coeff[4 * q + 3]));
+                hits[q] += __builtin_popcount(static_cast<unsigned int>(_mm512_cmp_pd_mask(dist, vtol, _CMP_LT_OQ)));
+            }
+        }
+        for (int q = 0; q < 4; q++) counts[h + q] += hits[q];
+        countPlaneInliersTileScalar<double>(x + full, y + full, z + full, n - full, p, 4, tolerance, counts + h);
+    }
+    countPlaneInliersTileScalar<double>(x, y, z, n, planes + 4 * h, k - h, tolerance, counts + h);
+}
+
+__attribute__((target("avx512f")))
+inline void countPlaneInliersTileAVX512f(const float *x, const float *y, const float *z, size_t n,
+                                         const float *planes, size_t k, float tolerance, size_t *counts){
+    const __m512 vtol = _mm512_set1_ps(tolerance);
+    const size_t full = n & ~size_t(15);
+
+    size_t h = 0;
+    for (; h + 4 <= k; h += 4) {
+        const float *p = planes + 4 * h;
+        __m512 coeff[16];
+        for (int j = 0; j < 16; j++) coeff[j] = _mm512_set1_ps(p[j]);
+
+        size_t hits[4] = {0, 0, 0, 0};
+        for (size_t i = 0; i < full; i += 16) {
+            const __m512 px = _mm512_loadu_ps(x + i), py = _mm512_loadu_ps(y + i), pz = _mm512_loadu_ps(z + i);
+            for (int q = 0; q < 4; q++) {
+                __m512 dist = _mm512_add_ps(_mm512_mul_ps(coeff[4 * q], px), _mm512_mul_ps(coeff[4 * q + 1], py));
+                dist = _mm512_add_ps(dist, _mm512_mul_ps(coeff[4 * q + 2], pz));
+                dist = _mm512_abs_ps(_mm512_add_ps(dist, coeff[4 * q + 3]));
+                hits[q] += __builtin_popcount(static_cast<unsigned int>(_mm512_cmp_ps_mask(dist, vtol, _CMP_LT_OQ)));
+            }
+        }
+        for (int q = 0; q < 4; q++) counts[h + q] += hits[q];
+        countPlaneInliersTileScalar<float>(x + full, y + full, z + full, n - full, p, 4, tolerance, counts + h);
+    }
+    countPlaneInliersTileScalar<float>(x, y, z, n, planes + 4 * h, k - h, tolerance, counts + h);
+}
+
+#endif
+
+template <typename Scalar>
+inline PlaneTileKernel<Scalar> selectPlaneTileKernel(const char **name = nullptr){
+#if RANSAC_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        if (name) *name = "avx512";
+        if constexpr (std::is_same<Scalar, float>::value) return countPlaneInliersTileAVX512f;
+        else return countPlaneInliersTileAVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        if (name) *name = "avx2";
+        if constexpr (std::is_same<Scalar, float>::value) return countPlaneInliersTileAVX2f;
+        else return countPlaneInliersTileAVX2;
+    }
+#endif
+    if (name) *name = "scalar";
+    return countPlaneInliersTileScalar<Scalar>;
+}
+
+// Converts n coordinates stored as T into a contiguous Scalar tile; a missing axis reads as 0
+template <typename T, typename Scalar>
+inline void gatherTile(const unsigned char *src, size_t stride, size_t n, Scalar *out){
+    if (!src) {
+        std::fill(out, out + n, Scalar(0));
+        return;
+    }
+    for (size_t i = 0, offset = 0; i < n; i++, offset += stride) {
+        T value;
+        std::memcpy(&value, src + offset, sizeof(T));
+        out[i] = static_cast<Scalar>(value);
+    }
+}
+
+// Counts the inliers of k planes among points [begin, begin + n) of a view, whatever its layout,
+// into counts[0..k). Structure-of-arrays Scalar data is scored in place; any other layout is
+// converted one tile at a time, so the conversion is paid once per batch rather than per plane.
+template <typename Scalar>
+inline void countPlaneInliersBatch(const PointView &points, size_t begin, size_t n,
+                                   const Scalar *planes, size_t k, Scalar tolerance, size_t *counts){
+    static const PlaneTileKernel<Scalar> kernel = selectPlaneTileKernel<Scalar>();
+
+    std::fill(counts, counts + k, size_t(0));
+    if (k == 0 || n == 0) return;
+
+    const size_t stride = points.byteStride();
+    const bool in_place = stride == sizeof(Scalar) && points.scalarType() == scalarTypeOf<Scalar>() && points.zBytes();
+    alignas(64) Scalar tile[3][kPlaneTilePoints];
+
+    for (size_t start = begin, end = begin + n; start < end; start += kPlaneTilePoints) {
+        const size_t len = std::min(kPlaneTilePoints, end - start);
+        const size_t offset = start * stride;
+        const unsigned char *xb = points.xBytes() + offset;
+        const unsigned char *yb = points.yBytes() + offset;
+        const unsigned char *zb = points.zBytes() ? points.zBytes() + offset : nullptr;
+
+        if (in_place) {
+            kernel(reinterpret_cast<const Scalar*>(xb), reinterpret_cast<const Scalar*>(yb),
+                   reinterpret_cast<const Scalar*>(zb), len, planes, k, tolerance, counts);
+            continue;
+        }
+        if (points.scalarType() == ScalarType::Float32) {
+            gatherTile<float, Scalar>(xb, stride, len, tile[0]);
+            gatherTile<float, Scalar>(yb, stride, len, tile[1]);
+            gatherTile<float, Scalar>(zb, stride, len, tile[2]);
+        } else {
+            gatherTile<double, Scalar>(xb, stride, len, tile[0]);
+            gatherTile<double, Scalar>(yb, stride, len, tile[1]);
+            gatherTile<double, Scalar>(zb, stride, len, tile[2]);
+        }
+        kernel(tile[0], tile[1], tile[2], len, planes, k, tolerance, counts);
+    }
+}
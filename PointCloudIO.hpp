@@ -0,0 +1,381 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Common.hpp"
+#include "PointView.hpp"
+
+// Read-only memory mapping of a whole file
+class MappedFile{
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile &&other) noexcept : bytes(other.bytes), length(other.length) {
+            other.bytes = nullptr;
+            other.length = 0;
+        }
+
+        MappedFile& operator=(MappedFile &&other) noexcept {
+            if (this != &other) {
+                close();
+                std::swap(bytes, other.bytes);
+                std::swap(length, other.length);
+            }
+            return *this;
+        }
+
+        bool open(const std::string &path){
+            close();
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+                ::close(fd);
+                return false;
+            }
+
+            void *mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (mapping == MAP_FAILED) return false;
+
+            madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+            bytes = static_cast<const unsigned char*>(mapping);
+            length = static_cast<size_t>(info.st_size);
+            return true;
+        }
+
+        void close(){
+            if (bytes) munmap(const_cast<unsigned char*>(bytes), length);
+            bytes = nullptr;
+            length = 0;
+        }
+
+        const unsigned char* data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        const unsigned char *bytes = nullptr;
+        size_t length = 0;
+};
+
+// Point cloud loaded from disk. Binary PLY, binary PCD and raw float files are memory-mapped
+// and viewed in place; ASCII formats are parsed once into an internal buffer. Either way
+// view() is what the estimators take, so the points are never copied a second time.
+class PointCloud{
+    public:
+        PointCloud() = default;
+        PointCloud(const PointCloud&) = delete;
+        PointCloud& operator=(const PointCloud&) = delete;
+        PointCloud(PointCloud&&) = default;
+        PointCloud& operator=(PointCloud&&) = default;
+
+        // Picks the format from the extension: .ply, .pcd, .xyz/.txt/.asc (ASCII), .bin (raw float32 x y z)
+        bool load(const std::string &path){
+            std::string ext = path.substr(path.find_last_of('.') == std::string::npos ? path.size() : path.find_last_of('.'));
+            std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char ch) { return std::tolower(ch); });
+
+            if (ext == ".ply") return loadPLY(path);
+            if (ext == ".pcd") return loadPCD(path);
+            if (ext == ".xyz" || ext == ".txt" || ext == ".asc") return loadXYZ(path);
+            if (ext == ".bin") return loadRaw(path);
+
+            std::cerr << "Unknown point cloud format: " << path << std::endl;
+            return false;
+        }
+
+        bool loadPLY(const std::string &path){
+            if (!openFile(path)) return false;
+
+            TextCursor cursor = cursorAtStart();
+            std::string_view line;
+            if (!cursor.nextLine(line) || trim(line) != "ply") return fail(path, "missing ply magic");
+
+            std::string format;
+            size_t vertex_count = 0;
+            bool in_vertex = false, seen_vertex = false;
+            Vec<Field> fields;
+
+            while (true) {
+                if (!cursor.nextLine(line)) return fail(path, "unterminated header");
+                std::istringstream tokens{std::string(trim(line))};
+                std::string keyword;
+                tokens >> keyword;
+
+                if (keyword == "end_header") break;
+                if (keyword == "format") tokens >> format;
+                else if (keyword == "element") {
+                    std::string name, token;
+                    size_t count = 0;
+                    tokens >> name >> token;
+                    if (!parseSize(token, count)) return fail(path, "malformed element count " + token);
+                    in_vertex = name == "vertex";
+                    if (in_vertex) {
+                        vertex_count = count;
+                        seen_vertex = true;
+                    } else if (!seen_vertex) {
+                        return fail(path, "vertex must be the first element");
+                    }
+                } else if (keyword == "property" && in_vertex) {
+                    std::string type, name;
+                    tokens >> type;
+                    if (type == "list") return fail(path, "list properties on vertices are not supported");
+                    tokens >> name;
+                    fields.push_back({name, plyTypeSize(type), type == "float" || type == "float32", type == "double" || type == "float64"});
+                    if (fields.back().size == 0) return fail(path, "unknown property type " + type);
+                }
+            }
+
+            if (format == "ascii") return parseColumns(path, cursor, fields, vertex_count);
+            if (format == "binary_little_endian") return mapRecords(path, cursor.offset(), fields, vertex_count);
+            return fail(path, "unsupported PLY format " + format);
+        }
+
+        bool loadPCD(const std::string &path){
+            if (!openFile(path)) return false;
+
+            TextCursor cursor = cursorAtStart();
+            std::string_view line;
+            Vec<std::string> names, types;
+            Vec<size_t> sizes, counts;
+            size_t points = 0;
+            std::string data;
+
+            while (data.empty()) {
+                if (!cursor.nextLine(line)) return fail(path, "unterminated header");
+                std::istringstream tokens{std::string(trim(line))};
+                std::string keyword, token;
+                tokens >> keyword;
+
+                if (keyword == "FIELDS") while (tokens >> token) names.push_back(token);
+                else if (keyword == "TYPE") while (tokens >> token) types.push_back(token);
+                else if (keyword == "DATA") tokens >> data;
+                else if (keyword == "SIZE" || keyword == "COUNT" || keyword == "POINTS") {
+                    Vec<size_t> &values = keyword == "SIZE" ? sizes : counts;
+                    while (tokens >> token) {
+                        size_t value = 0;
+                        if (!parseSize(token, value)) return fail(path, "malformed " + keyword + " value " + token);
+                        if (keyword == "POINTS") points = value;
+                        else values.push_back(value);
+                    }
+                }
+            }
+
+            if (counts.empty()) counts.assign(names.size(), 1);
+            if (sizes.size() != names.size() || types.size() != names.size() || counts.size() != names.size())
+                return fail(path, "inconsistent FIELDS/SIZE/TYPE/COUNT");
+            for (size_t f = 0; f < names.size(); f++) {
+                // A record larger than the file is corrupt, and would expand into that many columns
+                if (sizes[f] == 0 || counts[f] == 0 || counts[f] > file.size() / sizes[f])
+                    return fail(path, "bad SIZE or COUNT for field " + names[f]);
+            }
+
+            // Expand multi-count fields so every column has an entry
+            Vec<Field> fields;
+            for (size_t f = 0; f < names.size(); f++) {
+                for (size_t k = 0; k < counts[f]; k++) {
+                    bool is_float = types[f] == "F";
+                    fields.push_back({k == 0 ? names[f] : std::string(), sizes[f], is_float && sizes[f] == 4, is_float && sizes[f] == 8});
+                }
+            }
+
+            if (data == "ascii") return parseColumns(path, cursor, fields, points);
+            if (data == "binary") return mapRecords(path, cursor.offset(), fields, points);
+            return fail(path, "unsupported PCD data encoding " + data);
+        }
+
+        // Whitespace-separated text, x y z in the first three columns; '#' starts a comment line
+        bool loadXYZ(const std::string &path){
+            if (!openFile(path)) return false;
+
+            TextCursor cursor = cursorAtStart();
+            parsed.clear();
+            parsed.reserve(file.size() / 8);
+
+            std::string_view line;
+            while (cursor.nextLine(line)) {
+                line = trim(line);
+                if (line.empty() || line.front() == '#') continue;
+
+                double xyz[3];
+                if (!parseNumbers(line, xyz, 3)) return fail(path, "malformed line");
+                parsed.insert(parsed.end(), xyz, xyz + 3);
+            }
+
+            useParsed();
+            return true;
+        }
+
+        // Raw little-endian float32 records, x y z first, floats_per_point values per record
+        bool loadRaw(const std::string &path, size_t floats_per_point = 3){
+            if (floats_per_point < 3) return fail(path, "need at least 3 floats per point");
+            if (!openFile(path)) return false;
+
+            size_t record = floats_per_point * sizeof(float);
+            points = PointView::interleaved(file.data(), file.size() / record, record, 0, 4, 8, ScalarType::Float32);
+            return true;
+        }
+
+        const PointView& view() const { return points; }
+        size_t size() const { return points.size(); }
+
+    private:
+        struct Field{
+            std::string name;
+            size_t size;
+            bool is_float32;
+            bool is_float64;
+        };
+
+        struct TextCursor{
+            const char *begin, *pos, *end;
+
+            bool nextLine(std::string_view &line){
+                if (pos >= end) return false;
+                const char *eol = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+                if (!eol) eol = end;
+                line = std::string_view(pos, eol - pos);
+                pos = eol < end ? eol + 1 : end;
+                return true;
+            }
+
+            size_t offset() const { return pos - begin; }
+        };
+
+        MappedFile file;
+        Vec<double> parsed;
+        PointView points;
+
+        bool openFile(const std::string &path){
+            parsed.clear();
+            points = PointView();
+            if (!file.open(path)) {
+                std::cerr << "Could not open point cloud " << path << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        bool fail(const std::string &path, const std::string &reason){
+            std::cerr << "Failed to load " << path << ": " << reason << std::endl;
+            file.close();
+            parsed.clear();
+            points = PointView();
+            return false;
+        }
+
+        TextCursor cursorAtStart() const {
+            const char *text = reinterpret_cast<const char*>(file.data());
+            return TextCursor{text, text, text + file.size()};
+        }
+
+        void useParsed(){
+            points = PointView::interleaved(parsed.data(), parsed.size() / 3, 3 * sizeof(double),
+                                            0, sizeof(double), 2 * sizeof(double), ScalarType::Float64);
+        }
+
+        static std::string_view trim(std::string_view text){
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) text.remove_prefix(1);
+            while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) text.remove_suffix(1);
+            return text;
+        }
+
+        // Parses `count` numbers from the start of line, skipping whitespace
+        static bool parseNumbers(std::string_view line, double *out, size_t count){
+            const char *p = line.data(), *end = line.data() + line.size();
+            for (size_t i = 0; i < count; i++) {
+                while (p < end && std::isspace(static_cast<unsigned char>(*p))) p++;
+                auto result = std::from_chars(p, end, out[i]);
+                if (result.ec != std::errc()) return false;
+                p = result.ptr;
+            }
+            return true;
+        }
+
+        // Parses a whole token as an unsigned decimal
+        static bool parseSize(const std::string &token, size_t &out){
+            auto result = std::from_chars(token.data(), token.data() + token.size(), out);
+            return result.ec == std::errc() && result.ptr == token.data() + token.size();
+        }
+
+        static size_t plyTypeSize(const std::string &type){
+            if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") return 1;
+            if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") return 2;
+            if (type == "int" || type == "uint" || type == "int32" || type == "uint32") return 4;
+            if (type == "float" || type == "float32") return 4;
+            if (type == "double" || type == "float64") return 8;
+            return 0;
+        }
+
+        static bool findXYZ(const Vec<Field> &fields, size_t index[3]){
+            const char *names[3] = {"x", "y", "z"};
+            for (int axis = 0; axis < 3; axis++) {
+                auto it = std::find_if(fields.begin(), fields.end(), [&](const Field &f) { return f.name == names[axis]; });
+                if (it == fields.end()) return false;
+                index[axis] = it - fields.begin();
+            }
+            return true;
+        }
+
+        bool parseColumns(const std::string &path, TextCursor &cursor, const Vec<Field> &fields, size_t count){
+            size_t column[3];
+            if (!findXYZ(fields, column)) return fail(path, "missing x/y/z fields");
+            size_t last = std::max({column[0], column[1], column[2]});
+
+            // Every point takes at least a digit and a line break, which bounds a declared count
+            if (count > (file.size() - cursor.offset()) / 2) return fail(path, "file shorter than declared");
+            parsed.resize(3 * count);
+            Vec<double> values(last + 1);
+            std::string_view line;
+            for (size_t i = 0; i < count; i++) {
+                if (!cursor.nextLine(line)) return fail(path, "fewer points than declared");
+                if (!parseNumbers(line, values.data(), values.size())) return fail(path, "malformed line");
+                for (int axis = 0; axis < 3; axis++) parsed[3 * i + axis] = values[column[axis]];
+            }
+
+            useParsed();
+            return true;
+        }
+
+        bool mapRecords(const std::string &path, size_t data_offset, const Vec<Field> &fields, size_t count){
+            uint16_t probe = 1;
+            unsigned char first_byte;
+            std::memcpy(&first_byte, &probe, 1);
+            if (first_byte != 1) return fail(path, "binary clouds need a little-endian host");
+
+            size_t column[3];
+            if (!findXYZ(fields, column)) return fail(path, "missing x/y/z fields");
+
+            const Field &fx = fields[column[0]], &fy = fields[column[1]], &fz = fields[column[2]];
+            bool all32 = fx.is_float32 && fy.is_float32 && fz.is_float32;
+            bool all64 = fx.is_float64 && fy.is_float64 && fz.is_float64;
+            if (!all32 && !all64) return fail(path, "x/y/z must all be float or all be double");
+
+            size_t record = 0, offsets[3] = {0, 0, 0};
+            for (size_t f = 0; f < fields.size(); f++) {
+                for (int axis = 0; axis < 3; axis++) if (column[axis] == f) offsets[axis] = record;
+                record += fields[f].size;
+            }
+
+            if (record == 0 || count > (file.size() - data_offset) / record) return fail(path, "file shorter than declared");
+
+            points = PointView::interleaved(file.data() + data_offset, count, record, offsets[0], offsets[1], offsets[2],
+                                            all32 ? ScalarType::Float32 : ScalarType::Float64);
+            return true;
+        }
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "Common.hpp"
+
+enum class ScalarType { Float32, Float64 };
+
+template <typename T>
+constexpr ScalarType scalarTypeOf(){
+    static_assert(std::is_same<T, float>::value || std::is_same<T, double>::value, "points must be float or double");
+    return std::is_same<T, float>::value ? ScalarType::Float32 : ScalarType::Float64;
+}
+
+// Non-owning view over 3D points stored anywhere in memory. Each coordinate has its own
+// base pointer and all three share a byte stride, so array-of-structs, interleaved records
+// with extra fields and memory-mapped files can be read in place. Coordinates are read with
+// memcpy, so records need not be aligned. A null z pointer gives a 2D view.
+// The caller keeps the memory alive.
+class PointView{
+    public:
+        PointView() = default;
+
+        PointView(const void *x, const void *y, const void *z, size_t count, size_t stride, ScalarType type)
+            : px(static_cast<const unsigned char*>(x)), py(static_cast<const unsigned char*>(y)),
+              pz(static_cast<const unsigned char*>(z)), count(count), stride(stride), type(type) {}
+
+        // Records of record_size bytes with the coordinates at the given byte offsets
+        static PointView interleaved(const void *base, size_t count, size_t record_size,
+                                     size_t x_offset, size_t y_offset, size_t z_offset, ScalarType type){
+            const unsigned char *bytes = static_cast<const unsigned char*>(base);
+            return PointView(bytes + x_offset, bytes + y_offset, bytes + z_offset, count, record_size, type);
+        }
+
+        // Separate x, y and z arrays
+        template <typename T>
+        static PointView soa(const T *x, const T *y, const T *z, size_t count){
+            return PointView(x, y, z, count, sizeof(T), scalarTypeOf<T>());
+        }
+
+        // Packed x y z triples, or records of `stride` values with x y z first
+        template <typename T>
+        static PointView aos(const T *xyz, size_t count, size_t stride = 3){
+            return PointView(xyz, xyz + 1, xyz + 2, count, stride * sizeof(T), scalarTypeOf<T>());
+        }
+
+        // 2D points: z is absent and reads as 0
+        template <typename T>
+        static PointView of(const Vec<Pair<T, T>> &points){
+            if (points.empty()) return PointView();
+            return PointView(&points.front().first, &points.front().second, nullptr, points.size(),
+                             sizeof(Pair<T, T>), scalarTypeOf<T>());
+        }
+
+        template <typename T>
+        static PointView of(const Vec<Eigen::Matrix<T, 3, 1>> &points){
+            if (points.empty()) return PointView();
+            const T *first = points.front().data();
+            return PointView(first, first + 1, first + 2, points.size(), sizeof(Eigen::Matrix<T, 3, 1>), scalarTypeOf<T>());
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        double x(size_t i) const { return read(px, i); }
+        double y(size_t i) const { return read(py, i); }
+        double z(size_t i) const { return pz ? read(pz, i) : 0.0; }
+
+        Point3d operator[](size_t i) const { return Point3d(x(i), y(i), z(i)); }
+
+        // Raw layout, for kernels that read the memory directly
+        const unsigned char* xBytes() const { return px; }
+        const unsigned char* yBytes() const { return py; }
+        const unsigned char* zBytes() const { return pz; }
+        size_t byteStride() const { return stride; }
+        ScalarType scalarType() const { return type; }
+
+    private:
+        const unsigned char *px = nullptr, *py = nullptr, *pz = nullptr;
+        size_t count = 0;
+        size_t stride = 0;
+        ScalarType type = ScalarType::Float64;
+
+        double read(const unsigned char *base, size_t i) const {
+            const unsigned char *src = base + i * stride;
+            if (type == ScalarType::Float32) {
+                float value;
+                std::memcpy(&value, src, sizeof(value));
+                return value;
+            }
+            double value;
+            std::memcpy(&value, src, sizeof(value));
+            return value;
+        }
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include "Common.hpp"
+#include "PointView.hpp"
+#include "LineFit.hpp"
+#include "RansacEngine.hpp"
+
+template <typename Scalar>
+class LineModelT{
+    public:
+        Scalar m = 0;
+        Scalar b = 0;
+        bool defined = false;    // Set by the constructors: a default model is not a line
+
+        // Default Constructor
+        LineModelT() = default;
+
+        LineModelT(Scalar m, Scalar b) : m(m), b(b), defined(true) {}
+
+        // Defined Constructor
+        LineModelT(const Pair<Scalar, Scalar> &p1, const Pair<Scalar, Scalar> &p2) : defined(true) {
+            if(p2.first - p1.first != 0) m = (p2.second - p1.second) / (p2.first - p1.first);
+            else m = 1e10;
+            b = p1.second - m * p1.first; }
+        
+        Scalar computeError(const Pair<Scalar, Scalar> &pt) const {
+            Scalar y_estimated = m * pt.first + b;
+            return std::abs(y_estimated - pt.second); }
+
+        bool isValid() const { return defined && std::isfinite(m) && std::isfinite(b); }
+};
+
+using LineModel = LineModelT<double>;
+using LineModelf = LineModelT<float>;
+
+// Vertical residuals |m x + b - y| of 2D points; z is ignored. The engine's kernels always read
+// three coordinates, and a 2D view has no z, so the residual view repeats x as a stand-in third
+// coordinate. It is always finite and its coefficient in (m, -1, 0, b) is zero, so it never
+// changes a residual; it only spares the kernels a 2D variant.
+template <typename Scalar_ = double, typename Accumulator_ = double>
+struct LinePolicy{
+    using Scalar = Scalar_;
+    using Accumulator = Accumulator_;
+    using Model = LineModelT<Scalar>;
+    using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+    using InputPoint = Pair<Scalar, Scalar>;
+    using Moments = LineMoments<Accumulator>;
+    static constexpr size_t kSampleSize = 2;
+    static constexpr const char* kName = "line";
+
+    // Line through two distinct points
+    static bool solve(const std::array<Vector3, 2>& sample, Model& model) {
+        if (sample[0].x() == sample[1].x() && sample[0].y() == sample[1].y()) return false;
+        model = Model({sample[0].x(), sample[0].y()}, {sample[1].x(), sample[1].y()});
+        return true; }
+
+    static Scalar residual(const Model& model, const Vector3& p) { return model.computeError({p.x(), p.y()}); }
+
+    static PointView residualView(const PointView& points) {
+        return PointView(points.xBytes(), points.yBytes(), points.xBytes(), points.size(), points.byteStride(), points.scalarType()); }
+
+    static std::array<Scalar, 4> residualForm(const Model& model) { return {model.m, Scalar(-1), Scalar(0), model.b}; }
+
+    template <typename Point>
+    static void accumulate(Moments& moments, const Point& p) { moments.add(p.x(), p.y()); }
+
+    static Model fit(const Moments& moments) {
+        if (!moments.valid()) return Model();
+        return Model(static_cast<Scalar>(moments.slope()), static_cast<Scalar>(moments.intercept())); }
+
+    // Extent of y
+    static double outlierRange(const PointView& points) {
+        if (points.empty()) return 1.0;
+        double lo = points.y(0), hi = lo;
+        for (size_t i = 1; i < points.size(); i++) { lo = std::min(lo, points.y(i)); hi = std::max(hi, points.y(i)); }
+        return std::max(hi - lo, 1e-12); }
+};
+
+// Scalar is the precision of the points, model and scoring kernel; Accumulator is the
+// precision of the least-squares sums in the final refit
+template <typename Scalar = double, typename Accumulator = double>
+using LineRANSAC = RansacEngine<LinePolicy<Scalar, Accumulator>>;
+
+#ifdef RANSAC_PREBUILT
+extern template class RansacEngine<LinePolicy<double, double>>;
+extern template class RansacEngine<LinePolicy<float, double>>;
+#endif
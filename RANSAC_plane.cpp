@@ -1,211 +1,28 @@
 #include <iostream>
-#include <vector>
-#include <ctime>
-#include <cmath>
-#include <numeric>   
-#include <random>
-#include <algorithm> 
-#include <iterator>
-#include <Eigen/Dense>
+#include <cstdlib>
+#include "RANSAC_plane.hpp"
+#include "PointCloudIO.hpp"
 
-template <typename T>
-using Vec = std::vector<T>;
-using Point3d = Eigen::Vector3d;
+// Fits a plane to a point cloud file: RP <cloud.ply|.pcd|.xyz|.bin> [tolerance] [iterations]
+int runOnFile(int argc, char **argv) {
+    PointCloud cloud;
+    if (!cloud.load(argv[1])) return 1;
 
-class PlaneModel{
-    public:
-        double a = 0, b = 0, c = 0, d = 0;
-        Point3d normal; 
+    double tolerance = argc > 2 ? std::atof(argv[2]) : 0.4;
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 2000;
 
-        PlaneModel() = default;
+    PlaneRANSAC<> ransac_solver(cloud.view(), tolerance, iterations, 0);
+    PlaneModel plane = ransac_solver.run();
+    if (!plane.isValid()) return 1;
 
-        PlaneModel(const Point3d &pt1, const Point3d &pt2, const Point3d &pt3){
-            Point3d V1 = pt2 - pt1;
-            Point3d V2 = pt3 - pt1;
-
-            Point3d cross_product = V1.cross(V2); 
-
-            if (cross_product.norm() < 1e-9) { 
-                a = b = c = d = 0; 
-                return; 
-            }
-
-            normal = cross_product.normalized();
-
-            a = normal.x();
-            b = normal.y();
-            c = normal.z();
-            d = -normal.dot(pt1);
-        }
-
-        PlaneModel(const Point3d& normal_vec, const Point3d& centroid){
-            this->normal = normal_vec.normalized(); 
-            a = this->normal.x();
-            b = this->normal.y();
-            c = this->normal.z();
-            d = -this->normal.dot(centroid);
-        }
-        
-        double computeDistance(const Point3d &pt) const {
-            if (a*a + b*b + c*c < 1e-18) return 1e10; 
-            // Normal is already normalized, so denominator = 1
-            return std::abs(a * pt.x() + b * pt.y() + c * pt.z() + d); 
-        }
-        
-        bool isValid() const {
-            return normal.norm() > 1e-9;
-        }
-};
-
-class RANSAC{
-    private:
-        Vec<Point3d> data;
-        double error_tolerance;
-        int max_iterations;
-        int min_consensus;
-        std::mt19937 rng;
-
-        PlaneModel fitModel(const Vec<Point3d>& consensus_set){
-            if (consensus_set.size() < 3) return PlaneModel(); 
-
-            // Finding the Centroid
-            Point3d centroid = Point3d::Zero();
-            for (const auto& pt : consensus_set) centroid += pt;
-            centroid /= consensus_set.size();
-
-            // Centering every row through a matrix
-            Eigen::MatrixXd centered_data(consensus_set.size(), 3);
-            for (size_t i = 0; i < consensus_set.size(); ++i) {
-                centered_data.row(i) = (consensus_set[i] - centroid).transpose();
-            }
-            
-            // Extracting normal vector through SVD
-            Eigen::JacobiSVD<Eigen::MatrixXd> svd(centered_data, Eigen::ComputeThinV);
-            Point3d normal_vector = svd.matrixV().col(2);
-
-            // Ensure consistent normal orientation
-            if (normal_vector.dot(centroid) > 0) {
-                normal_vector = -normal_vector;
-            }
-
-            return PlaneModel(normal_vector, centroid);
-        }
-
-        Vec<Point3d> getConsensusSet(const PlaneModel& model) const {
-            Vec<Point3d> consensus_set;
-            if (!model.isValid()) return consensus_set;
-            
-            for (const auto &pt : data) {
-                if (model.computeDistance(pt) < error_tolerance) {
-                    consensus_set.push_back(pt);
-                }
-            }
-            return consensus_set;
-        }
-
-        bool areCollinear(const Point3d& p1, const Point3d& p2, const Point3d& p3) const {
-            Point3d v1 = p2 - p1;
-            Point3d v2 = p3 - p1;
-            return v1.cross(v2).norm() < 1e-9;
-        }
-
-    public:
-        RANSAC(Vec<Point3d> points, double error_tolerance, int max_iterations, int min_consensus) 
-        : data(points), error_tolerance(error_tolerance), max_iterations(max_iterations), 
-          min_consensus(min_consensus), rng(std::random_device{}()) {}
-        
-        PlaneModel run() {
-            if (data.size() < 3) {
-                std::cerr << "Insufficient data points for plane fitting." << std::endl;
-                return PlaneModel();
-            }
-
-            int bestInliersCount = 0;
-            Vec<Point3d> bestConsensusSet;
-            int attempts_without_improvement = 0;
-            const int max_attempts_without_improvement = max_iterations / 4;
-
-            for (int i = 0; i < max_iterations; i++) {
-                // Random Sampling with improved strategy
-                Vec<int> indices(data.size());
-                std::iota(indices.begin(), indices.end(), 0);
-                std::shuffle(indices.begin(), indices.end(), rng);
-                
-                // Find three non-collinear points
-                PlaneModel currentModel;
-                bool found_valid_sample = false;
-                
-                for (int attempt = 0; attempt < std::min(10, (int)data.size() - 2); attempt++) {
-                    if (indices.size() < 3) break;
-                    
-                    Point3d p1 = data[indices[attempt]];
-                    Point3d p2 = data[indices[attempt + 1]];
-                    Point3d p3 = data[indices[attempt + 2]];
-                    
-                    if (!areCollinear(p1, p2, p3)) {
-                        currentModel = PlaneModel(p1, p2, p3);
-                        if (currentModel.isValid()) {
-                            found_valid_sample = true;
-                            break;
-                        }
-                    }
-                }
-                
-                if (!found_valid_sample) continue;
-
-                // Get consensus set for current model 
-                Vec<Point3d> currentConsensusSet = getConsensusSet(currentModel);
-
-                // Only update if we found more inliers 
-                if (static_cast<int>(currentConsensusSet.size()) > bestInliersCount) {
-                    bestInliersCount = currentConsensusSet.size();
-                    bestConsensusSet = currentConsensusSet;
-                    attempts_without_improvement = 0;
-                } else {
-                    attempts_without_improvement++;
-                }
-
-                // Early termination conditions
-                if (bestInliersCount >= min_consensus && 
-                    (attempts_without_improvement > max_attempts_without_improvement)) {
-                    break;
-                }
-            }
-
-            // Final model fitting with best consensus set 
-            if (!bestConsensusSet.empty() && bestConsensusSet.size() >= 3) {
-                PlaneModel finalModel = fitModel(bestConsensusSet);
-                if (finalModel.isValid()) {
-                    std::cout << "RANSAC converged with " << bestInliersCount << " inliers out of " << data.size() << " points." << std::endl;
-                    return finalModel;
-                }
-            }
-            
-            std::cerr << "RANSAC failed to find a valid consensus set." << std::endl;
-            return PlaneModel();
-        }
-
-        // Method to evaluate model quality
-        double evaluateModel(const PlaneModel& model) const {
-            if (!model.isValid()) return 1e10;
-            
-            double total_error = 0.0;
-            int inlier_count = 0;
-            
-            for (const auto& pt : data) {
-                double dist = model.computeDistance(pt);
-                if (dist < error_tolerance) {
-                    total_error += dist;
-                    inlier_count++;
-                }
-            }
-            
-            if (inlier_count == 0) return 1e10;
-            return total_error / inlier_count; 
-        }
-};      
+    std::cout << "Loaded " << cloud.size() << " points from " << argv[1] << std::endl;
+    std::cout << "Best fitted plane equation: " << plane.a << "x + " << plane.b << "y + " << plane.c << "z + " << plane.d << " = 0" << std::endl;
+    std::cout << "Total inliers: " << ransac_solver.getInliers().size() << " after " << ransac_solver.getIterations() << " iterations" << std::endl;
+    return 0;
+}
 
-int main() {
+int main(int argc, char **argv) {
+    if (argc > 1) return runOnFile(argc, argv);
     
     Vec<Point3d> points;
 
@@ -233,9 +50,14 @@ int main() {
     int iterations = 2000;  
     int min_pts_for_consensus = 0.6 * points.size(); 
 
-    RANSAC ransac_solver(points, tolerance, iterations, min_pts_for_consensus);
+    PlaneRANSAC<> ransac_solver(points, tolerance, iterations, min_pts_for_consensus);
     PlaneModel best_fitted_plane = ransac_solver.run();
 
+    if (best_fitted_plane.isValid()) {
+        std::cout << "RANSAC converged with " << ransac_solver.getInliers().size() << " inliers out of " << points.size() << " points"
+                  << " after " << ransac_solver.getIterations() << " iterations." << std::endl;
+    }
+
     std::cout << "\n--- RANSAC Results ---" << std::endl;
     if (best_fitted_plane.isValid()) { 
         std::cout << "Best fitted plane equation: "
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include "Common.hpp"
+#include "PointView.hpp"
+#include "PlaneFit.hpp"
+#include "RansacEngine.hpp"
+
+template <typename Scalar>
+class PlaneModelT{
+    public:
+        using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+
+        Scalar a = 0, b = 0, c = 0, d = 0;
+        Vector3 normal = Vector3::Zero(); 
+
+        PlaneModelT() = default;
+
+        PlaneModelT(const Vector3 &pt1, const Vector3 &pt2, const Vector3 &pt3){
+            Vector3 V1 = pt2 - pt1;
+            Vector3 V2 = pt3 - pt1;
+
+            Vector3 cross_product = V1.cross(V2); 
+
+            if (cross_product.norm() < 1e-9) { 
+                a = b = c = d = 0; 
+                return; 
+            }
+
+            normal = cross_product.normalized();
+
+            a = normal.x();
+            b = normal.y();
+            c = normal.z();
+            d = -normal.dot(pt1);
+        }
+
+        PlaneModelT(const Vector3& normal_vec, const Vector3& centroid){
+            this->normal = normal_vec.normalized(); 
+            a = this->normal.x();
+            b = this->normal.y();
+            c = this->normal.z();
+            d = -this->normal.dot(centroid);
+        }
+        
+        Scalar computeDistance(const Vector3 &pt) const {
+            if (a*a + b*b + c*c < 1e-18) return 1e10; 
+            // Normal is already normalized, so denominator = 1
+            return std::abs(a * pt.x() + b * pt.y() + c * pt.z() + d); 
+        }
+        
+        bool isValid() const {
+            return normal.norm() > 1e-9;
+        }
+};
+
+using PlaneModel = PlaneModelT<double>;
+using PlaneModelf = PlaneModelT<float>;
+
+// Point-to-plane distance; the residual view is the points themselves
+template <typename Scalar_ = double, typename Accumulator_ = double>
+struct PlanePolicy{
+    using Scalar = Scalar_;
+    using Accumulator = Accumulator_;
+    using Model = PlaneModelT<Scalar>;
+    using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+    using InputPoint = Vector3;
+    using Moments = PlaneScatter<Accumulator>;
+    static constexpr size_t kSampleSize = 3;
+    static constexpr const char* kName = "plane";
+
+    // Plane through three non-collinear points
+    static bool solve(const std::array<Vector3, 3>& sample, Model& model) {
+        if ((sample[1] - sample[0]).cross(sample[2] - sample[0]).norm() < 1e-9) return false;
+        model = Model(sample[0], sample[1], sample[2]);
+        return true;
+    }
+
+    static Scalar residual(const Model& model, const Vector3& p) { return model.computeDistance(p); }
+
+    static PointView residualView(const PointView& points) { return points; }
+
+    static std::array<Scalar, 4> residualForm(const Model& model) { return {model.a, model.b, model.c, model.d}; }
+
+    template <typename Point>
+    static void accumulate(Moments& moments, const Point& p) { moments.add(p.template cast<Accumulator>()); }
+
+    // Covariance fit, with the normal oriented consistently (d >= 0)
+    static Model fit(const Moments& moments) {
+        if (moments.count() < 3) return Model();
+        auto centroid = moments.centroid();
+        auto normal_vector = moments.normal();
+        if (normal_vector.dot(centroid) > 0) normal_vector = -normal_vector;
+        return Model(normal_vector.template cast<Scalar>(), centroid.template cast<Scalar>());
+    }
+
+    // Diagonal of the bounding box
+    static double outlierRange(const PointView& points) {
+        if (points.empty()) return 1.0;
+        Point3d lo = points[0], hi = points[0];
+        for (size_t i = 1; i < points.size(); i++) {
+            Point3d p = points[i];
+            lo = lo.cwiseMin(p);
+            hi = hi.cwiseMax(p);
+        }
+        return std::max((hi - lo).norm(), 1e-12);
+    }
+};
+
+// Scalar is the precision of the points, models and scoring kernels; Accumulator is the
+// precision of the final least-squares refit
+template <typename Scalar = double, typename Accumulator = double>
+using PlaneRANSAC = RansacEngine<PlanePolicy<Scalar, Accumulator>>;
+
+#ifdef RANSAC_PREBUILT
+extern template class RansacEngine<PlanePolicy<double, double>>;
+extern template class RansacEngine<PlanePolicy<float, double>>;
+#endif
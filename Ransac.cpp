@@ -0,0 +1,14 @@
+#include "Ransac.hpp"
+
+// Instantiations shipped in the ransac library; each header declares its own extern under
+// RANSAC_PREBUILT. Float points with double refits cover the memory-bound configurations.
+template class RansacEngine<LinePolicy<double, double>>;
+template class RansacEngine<LinePolicy<float, double>>;
+template class RansacEngine<PlanePolicy<double, double>>;
+template class RansacEngine<PlanePolicy<float, double>>;
+
+template class MultiPlaneExtractor<double, double>;
+template class DownsampledPlaneRANSAC<double, double>;
+template class PlaneTracker<double, double>;
+template class StreamingRANSAC<LineStreamPolicy<double, double>>;
+template class StreamingRANSAC<PlaneStreamPolicy<double, double>>;
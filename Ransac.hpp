@@ -0,0 +1,18 @@
+#pragma once
+
+// Public API of the ransac library: the estimators, their models, options and result types, and
+// point cloud input. Linking the ransac target defines RANSAC_PREBUILT, so the instantiations
+// built into the library (see Ransac.cpp) are not compiled again by every consumer; any other
+// Scalar / Accumulator combination is instantiated from the headers as usual.
+
+#include "PointView.hpp"
+#include "PointCloudIO.hpp"
+#include "ThreadPool.hpp"
+#include "RansacEngine.hpp"
+#include "RANSAC_line.hpp"
+#include "RANSAC_plane.hpp"
+#include "MultiPlane.hpp"
+#include "Downsample.hpp"
+#include "Tracking.hpp"
+#include "StreamingLine.hpp"
+#include "StreamingPlane.hpp"
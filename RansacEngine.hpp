@@ -0,0 +1,970 @@
+#pragma once
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include "Common.hpp"
+#include "PointView.hpp"
+#include "Sampler.hpp"
+#include "PlaneKernels.hpp"
+#include "Termination.hpp"
+#include "ThreadPool.hpp"
+#include "SPRT.hpp"
+#include "Scoring.hpp"
+#include "Octree.hpp"
+
+// Settings for RansacEngine::runPreemptive(). A budget of 0 means unlimited.
+struct PreemptiveOptions{
+    int hypotheses = 128;              // generated up front
+    size_t block_size = 100;           // points scored per round before halving
+    double time_budget_ms = 0;         // wall-clock deadline, hypothesis generation included
+    size_t evaluation_budget = 0;      // maximum point-hypothesis evaluations
+    bool refine = false;               // full inlier pass and least-squares refit (not budgeted)
+};
+
+// Settings for RansacEngine::enableLocalOptimization()
+struct LocalOptimizationOptions{
+    int inner_iterations = 10;          // non-minimal samples drawn from the best consensus set
+    size_t sample_size = 12;            // points per inner sample, capped at half the consensus set
+    int refit_steps = 4;                // least-squares refits per sample
+    double threshold_multiplier = 3.0;  // threshold of the first refit, in tolerances; shrinks to 1
+};
+
+// What runPreemptive() actually spent
+struct PreemptiveReport{
+    int hypotheses = 0;                // valid hypotheses generated
+    int survivors = 0;                 // hypotheses still alive when scoring stopped
+    size_t blocks = 0;                 // blocks of points scored
+    size_t evaluations = 0;            // point-hypothesis evaluations
+    double elapsed_ms = 0;             // budgeted time, without the refine
+    bool budget_exhausted = false;     // stopped by a budget rather than by converging to one hypothesis
+};
+
+// One RANSAC for every model whose residual is affine in the point: sampling, scoring, termination
+// and all their variants are written once against a Model policy, resolved at compile time with
+// no virtual calls. A policy provides:
+//
+//   Scalar, Accumulator        precision of the points, models and scoring kernels, and of the refit
+//   Model                      default-constructs invalid and has isValid()
+//   InputPoint                 element type of the owning constructor's Vec, viewed by PointView::of()
+//   kSampleSize, kName         points per minimal sample; model name for error messages
+//   solve(sample, model)       minimal solver on kSampleSize points (Vector3), false when degenerate
+//   residualView(points)       three coordinates per point as the scoring kernels read them
+//   residualForm(model)        (a, b, c, d) such that the residual is |a x + b y + c z + d| over the
+//                              residual view. Every scoring path (counting, batched, losses, SPRT,
+//                              culling, preemptive) evaluates only this form, in the SIMD kernels
+//   residual(model, p)         the same residual on one point of the input, used where points are
+//                              classified one by one (final inliers, local optimization, PROSAC's
+//                              reordering); it must agree with the form
+//   Moments, accumulate(), fit()   least-squares sums of a consensus set and the refit from them,
+//                              invalid when the set is too small or degenerate
+//   outlierRange(points)       spread of outlier residuals, for MLESAC
+//
+// A residual that is not |affine| (a circle, a homography) cannot be expressed and needs its own
+// scoring loops. See PlanePolicy in RANSAC_plane.hpp and LinePolicy in RANSAC_line.hpp.
+// Scalar = float halves the bytes per point and doubles the SIMD lanes while still refitting in
+// Accumulator precision.
+template <typename Policy>
+class RansacEngine{
+    public:
+        using Scalar = typename Policy::Scalar;
+        using Accumulator = typename Policy::Accumulator;
+        using Model = typename Policy::Model;
+        using InputPoint = typename Policy::InputPoint;
+        using Vector3 = Eigen::Matrix<Scalar, 3, 1>;
+        static constexpr size_t kSampleSize = Policy::kSampleSize;
+
+    private:
+        // Points of the Vec constructor. Shared and never modified, so a copy of the estimator
+        // keeps the buffer its views point into alive, whichever of the two is destroyed first.
+        std::shared_ptr<const Vec<InputPoint>> owned_points;
+        PointView data;
+        PointView residuals;    // Policy::residualView(data), what the SIMD kernels read
+        Scalar error_tolerance;
+        int max_iterations;
+        int min_consensus;
+        double confidence;
+        int iterations = 0;
+        UniformSampler sampler;
+        Vec<size_t> inliers;
+
+        // Data-partitioned scoring for very large clouds, see enablePartitionedScoring()
+        ThreadPool* scoring_pool = nullptr;
+        size_t partition_min_points = 0;
+        size_t chunk_points = 0;
+        Vec<size_t> partial_counts;
+
+        // Batched scoring, see enableBatchedScoring()
+        size_t batch_size = 0;
+        Vec<Model> batch_models;
+        Vec<Scalar> batch_planes;    // batch_size rows of residual forms (a, b, c, d)
+        Vec<size_t> batch_counts;
+
+        // Preemptive scoring, see runPreemptive()
+        Vec<Scalar> block_x, block_y, block_z;
+        Vec<Scalar> block_planes;    // residual forms of the surviving hypotheses
+        Vec<size_t> block_counts;
+        PreemptiveReport preemptive_report;
+
+        // PROSAC sampling, see enablePROSAC()
+        bool use_prosac = false;
+        ProsacSampler prosac;
+        double prosac_beta = 0.05;
+        Vec<unsigned char> prosac_flags;
+
+        // Spatially local sampling, see enableNAPSAC()
+        bool use_napsac = false;
+        NapsacOptions napsac_options;
+        NapsacSampler napsac;
+
+        // Scoring policy, see setScoring()
+        ScoringMethod scoring = ScoringMethod::Count;
+        double mlesac_gamma = 0.5;
+        LossParams<Scalar> loss_params;
+        Vec<double> partial_losses;
+
+        // Per-point weights, see setWeights()
+        const Scalar* point_weights = nullptr;
+        double total_weight = 0;
+        WeightedSampler weighted_sampler;
+
+        // Local optimization, see enableLocalOptimization()
+        bool use_lo = false;
+        LocalOptimizationOptions lo_options;
+        Vec<Vector3> lo_points;    // Points within the widest refit threshold of the best model
+        Vec<size_t> lo_inliers, lo_subset;
+        std::mt19937 lo_rng{std::random_device{}()};
+        int lo_runs = 0;
+
+        // Warm start, see setInitialHypotheses()
+        Vec<Model> seeds;
+
+        // Spatial culling, see enableSpatialCulling()
+        bool use_culling = false;
+        size_t culling_leaf_size = 128;
+        PointOctree<Scalar> octree;
+
+        // SPRT verification, see enableSPRT()
+        bool use_sprt = false;
+        SPRT sprt;
+        Vec<Scalar> sprt_x, sprt_y, sprt_z;    // Shuffled copy of the points, only built for SPRT
+        static constexpr size_t kSPRTBlock = 128;
+
+        // Least-squares refit of the consensus set, accumulated in one pass
+        Model fitModel(const Vec<size_t>& consensus_set){
+            if (consensus_set.size() < kSampleSize) return Model();
+
+            typename Policy::Moments moments;
+            for (size_t idx : consensus_set) Policy::accumulate(moments, data[idx]);
+            return Policy::fit(moments);
+        }
+
+        Scalar residual(const Model& model, const Vector3& p) const { return Policy::residual(model, p); }
+
+        // Scoring path used inside the hypothesis loop: counts only, no allocation
+        int countInliers(const Model& model) const {
+            if (!model.isValid()) return 0;
+            const auto k = Policy::residualForm(model);
+            if (point_weights) {
+                LossParams<Scalar> count_params;
+                count_params.threshold2 = error_tolerance * error_tolerance;
+                double outliers = planeLoss<CountLoss, Scalar>(residuals, 0, data.size(), k[0], k[1], k[2], k[3],
+                                                               count_params, point_weights);
+                return static_cast<int>(std::lround(total_weight - outliers));
+            }
+            if (use_culling) return static_cast<int>(octree.countPlaneInliers(k[0], k[1], k[2], k[3], error_tolerance));
+
+            return static_cast<int>(countPlaneInliers<Scalar>(residuals, 0, data.size(), k[0], k[1], k[2], k[3], error_tolerance));
+        }
+
+        // Scores one hypothesis across the whole pool: each task counts one cache-sized chunk
+        // into its own slot and the partial counts are summed afterwards
+        int countInliersPartitioned(const Model& model) {
+            if (!model.isValid()) return 0;
+
+            const auto k = Policy::residualForm(model);
+            const size_t n = data.size();
+            const size_t chunks = (n + chunk_points - 1) / chunk_points;
+            partial_counts.assign(chunks, 0);
+
+            scoring_pool->parallelFor(chunks, [&](size_t chunk) {
+                size_t begin = chunk * chunk_points;
+                size_t count = std::min(chunk_points, n - begin);
+                partial_counts[chunk] = countPlaneInliers<Scalar>(residuals, begin, count, k[0], k[1], k[2], k[3], error_tolerance);
+            });
+
+            size_t total = 0;
+            for (size_t partial : partial_counts) total += partial;
+            return static_cast<int>(total);
+        }
+
+        // Total loss of a hypothesis under the selected scoring method, lower is better
+        double scoreLoss(const Model& model, bool partitioned) {
+            if (!model.isValid()) return std::numeric_limits<double>::infinity();
+            const auto k = Policy::residualForm(model);
+            if (!partitioned) return planeLoss<Scalar>(scoring, residuals, 0, data.size(), k[0], k[1], k[2], k[3], loss_params, point_weights);
+
+            const size_t n = data.size();
+            const size_t chunks = (n + chunk_points - 1) / chunk_points;
+            partial_losses.assign(chunks, 0.0);
+
+            scoring_pool->parallelFor(chunks, [&](size_t chunk) {
+                size_t begin = chunk * chunk_points;
+                size_t len = std::min(chunk_points, n - begin);
+                partial_losses[chunk] = planeLoss<Scalar>(scoring, residuals, begin, len, k[0], k[1], k[2], k[3], loss_params, point_weights);
+            });
+
+            double total = 0;
+            for (double partial : partial_losses) total += partial;
+            return total;
+        }
+
+        // Higher is better. In the units of the loop that runs local optimization: the inlier count
+        // in run()'s counting loop, the negated loss in runScored(), which weighted runs always take
+        double quality(const Model& model) {
+            if (scoring == ScoringMethod::Count && !point_weights) return countInliers(model);
+            return -scoreLoss(model, false);
+        }
+
+        // Counts the inliers of every initial hypothesis; the best one becomes the first best of the
+        // run. Returns its count, 0 without initial hypotheses.
+        int scoreSeeds(Model& best) {
+            int bestCount = 0;
+            for (const Model& seed : seeds) {
+                int count = countInliers(seed);
+                if (count > bestCount) {
+                    bestCount = count;
+                    best = seed;
+                }
+            }
+            return bestCount;
+        }
+
+        // run() under a robust loss: hypotheses compete on their total loss, while the iteration
+        // bound still follows the inlier count of the current best
+        Model runScored(bool partitioned) {
+            const double outlier_range = scoring == ScoringMethod::MLESAC ? Policy::outlierRange(data) : 1.0;
+            loss_params = makeLossParams<Scalar>(scoring, error_tolerance, mlesac_gamma, outlier_range);
+
+            double bestLoss = std::numeric_limits<double>::infinity();
+            int bestInliersCount = 0;
+            Model bestHypothesis;
+            int iteration_limit = max_iterations;
+
+            for (const Model& seed : seeds) {
+                double seedLoss = scoreLoss(seed, partitioned);
+                if (seedLoss < bestLoss) {
+                    bestLoss = seedLoss;
+                    bestHypothesis = seed;
+                }
+            }
+            if (bestHypothesis.isValid()) {
+                bestInliersCount = countInliers(bestHypothesis);
+                iteration_limit = boundFor(bestHypothesis, bestInliersCount);
+            }
+
+            for (iterations = 0; iterations < iteration_limit; iterations++) {
+                Model currentModel;
+                if (!drawNext(currentModel)) continue;
+
+                double currentLoss = scoreLoss(currentModel, partitioned);
+                if (currentLoss < bestLoss) {
+                    bestLoss = currentLoss;
+                    bestHypothesis = currentModel;
+                    if (use_lo) {
+                        double bestQuality = -bestLoss;
+                        localOptimize(bestHypothesis, bestQuality);
+                        bestLoss = -bestQuality;
+                    }
+
+                    bestInliersCount = countInliers(bestHypothesis);
+                    iteration_limit = boundFor(bestHypothesis, bestInliersCount);
+                }
+            }
+
+            return refine(bestHypothesis, bestInliersCount);
+        }
+
+        // Least-squares fit of lo_points[subset]
+        Model fitLocal(const Vec<size_t>& subset) const {
+            if (subset.size() < kSampleSize) return Model();
+
+            typename Policy::Moments moments;
+            for (size_t i : subset) Policy::accumulate(moments, lo_points[i]);
+            return Policy::fit(moments);
+        }
+
+        // Least-squares refits on the local points within a threshold that shrinks from
+        // threshold_multiplier tolerances down to the tolerance
+        Model iterativeRefit(Model model) {
+            const int steps = std::max(1, lo_options.refit_steps);
+            const double widest = std::max(1.0, lo_options.threshold_multiplier);
+
+            for (int step = 0; step < steps && model.isValid(); step++) {
+                double scale = steps == 1 ? 1.0 : widest - (widest - 1.0) * step / (steps - 1);
+                Scalar threshold = error_tolerance * static_cast<Scalar>(scale);
+
+                lo_subset.clear();
+                for (size_t i = 0; i < lo_points.size(); i++) {
+                    if (residual(model, lo_points[i]) < threshold) lo_subset.push_back(i);
+                }
+                Model fitted = fitLocal(lo_subset);
+                if (!fitted.isValid()) break;
+                model = fitted;
+            }
+            return model;
+        }
+
+        // Lo-RANSAC (Chum et al.), run on every new best: an inner RANSAC draws non-minimal samples
+        // from the consensus set, and each sample fit is polished by iterativeRefit(). Candidates are
+        // scored on the whole cloud and replace best only if they score better (see quality()). Only
+        // the points near best are gathered, once, so the inner loop never touches the full cloud.
+        void localOptimize(Model& best, double& best_quality) {
+            lo_runs++;
+            const Scalar widest = error_tolerance * static_cast<Scalar>(std::max(1.0, lo_options.threshold_multiplier));
+
+            lo_points.clear();
+            lo_inliers.clear();
+            for (size_t i = 0; i < data.size(); i++) {
+                Vector3 p = point(i);
+                Scalar distance = residual(best, p);
+                if (distance >= widest) continue;
+                if (distance < error_tolerance) lo_inliers.push_back(lo_points.size());
+                lo_points.push_back(p);
+            }
+
+            auto consider = [&](const Model& candidate) {
+                if (!candidate.isValid()) return;
+                double candidate_quality = quality(candidate);
+                if (candidate_quality > best_quality) {
+                    best = candidate;
+                    best_quality = candidate_quality;
+                }
+            };
+
+            consider(iterativeRefit(best));
+
+            const size_t sample = std::min(lo_options.sample_size, lo_inliers.size() / 2);
+            if (sample < kSampleSize) return;
+
+            for (int inner = 0; inner < lo_options.inner_iterations; inner++) {
+                // Partial Fisher-Yates: the first `sample` entries become a random subset
+                for (size_t k = 0; k < sample; k++) {
+                    size_t j = std::uniform_int_distribution<size_t>(k, lo_inliers.size() - 1)(lo_rng);
+                    std::swap(lo_inliers[k], lo_inliers[j]);
+                }
+                lo_subset.assign(lo_inliers.begin(), lo_inliers.begin() + sample);
+                consider(iterativeRefit(fitLocal(lo_subset)));
+            }
+        }
+
+        // Scores the first count hypotheses packed in batch_planes into batch_counts. With
+        // partitioned scoring every task scores the whole batch on its own chunk.
+        void countInliersBatch(size_t count, bool partitioned) {
+            batch_counts.resize(count);
+            if (!partitioned) {
+                countPlaneInliersBatch<Scalar>(residuals, 0, data.size(), batch_planes.data(), count, error_tolerance, batch_counts.data());
+                return;
+            }
+
+            const size_t n = data.size();
+            const size_t chunks = (n + chunk_points - 1) / chunk_points;
+            partial_counts.assign(chunks * count, 0);
+
+            scoring_pool->parallelFor(chunks, [&](size_t chunk) {
+                size_t begin = chunk * chunk_points;
+                size_t len = std::min(chunk_points, n - begin);
+                countPlaneInliersBatch<Scalar>(residuals, begin, len, batch_planes.data(), count, error_tolerance,
+                                               partial_counts.data() + chunk * count);
+            });
+
+            std::fill(batch_counts.begin(), batch_counts.end(), size_t(0));
+            for (size_t chunk = 0; chunk < chunks; chunk++) {
+                for (size_t h = 0; h < count; h++) batch_counts[h] += partial_counts[chunk * count + h];
+            }
+        }
+
+        // Writes the residual form of model into row slot of rows (4 values per row)
+        static void packPlane(Vec<Scalar>& rows, size_t slot, const Model& model) {
+            const auto k = Policy::residualForm(model);
+            std::copy(k.begin(), k.end(), &rows[4 * slot]);
+        }
+
+        // run() with batched scoring: hypotheses are drawn batch_size at a time (never past the
+        // current iteration bound) and scored together; the bound is updated between batches
+        Model runBatched(bool partitioned) {
+            Model bestHypothesis;
+            int bestInliersCount = scoreSeeds(bestHypothesis);
+            int iteration_limit = bestInliersCount > 0 ? boundFor(bestHypothesis, bestInliersCount) : max_iterations;
+
+            iterations = 0;
+            while (iterations < iteration_limit) {
+                const size_t wanted = std::min<size_t>(batch_size, iteration_limit - iterations);
+                size_t count = 0;
+                for (size_t j = 0; j < wanted; j++, iterations++) {
+                    if (!drawNext(batch_models[count])) continue;
+                    packPlane(batch_planes, count, batch_models[count]);
+                    count++;
+                }
+                if (count == 0) continue;
+
+                countInliersBatch(count, partitioned);
+
+                const int previousBest = bestInliersCount;
+                for (size_t h = 0; h < count; h++) {
+                    int currentInliersCount = static_cast<int>(batch_counts[h]);
+                    if (currentInliersCount > bestInliersCount) {
+                        bestInliersCount = currentInliersCount;
+                        bestHypothesis = batch_models[h];
+                    }
+                }
+                if (bestInliersCount > previousBest) {
+                    if (use_lo) {
+                        double bestQuality = bestInliersCount;
+                        localOptimize(bestHypothesis, bestQuality);
+                        bestInliersCount = static_cast<int>(bestQuality);
+                    }
+                    iteration_limit = boundFor(bestHypothesis, bestInliersCount);
+                }
+            }
+
+            return refine(bestHypothesis, bestInliersCount);
+        }
+
+        // SPRT verification: scans the (shuffled) points block by block and abandons the model as
+        // soon as the likelihood ratio says it is bad. Returns -1 for a rejected model.
+        int countInliersSPRT(const Model& model) {
+            if (!model.isValid()) return 0;
+
+            const auto k = Policy::residualForm(model);
+            const size_t n = data.size();
+            const PointView sprt_view = PointView::soa(sprt_x.data(), sprt_y.data(), sprt_z.data(), n);
+            size_t count = 0;
+            double log_lambda = 0;
+
+            for (size_t begin = 0; begin < n; begin += kSPRTBlock) {
+                size_t len = std::min(kSPRTBlock, n - begin);
+                size_t consistent = countPlaneInliers<Scalar>(sprt_view, begin, len, k[0], k[1], k[2], k[3], error_tolerance);
+                count += consistent;
+                log_lambda += sprt.blockLogRatio(consistent, len);
+
+                if (sprt.reject(log_lambda)) {
+                    sprt.onRejected(count, begin + len);
+                    return -1;
+                }
+            }
+            return static_cast<int>(count);
+        }
+
+        // Single pass run once for the winning hypothesis
+        void collectInliers(const Model& model, Vec<size_t>& out) const {
+            out.clear();
+            if (!model.isValid()) return;
+
+            for (size_t i = 0; i < data.size(); i++) {
+                if (residual(model, point(i)) < error_tolerance) out.push_back(i);
+            }
+        }
+
+        Vector3 point(size_t i) const { return data[i].template cast<Scalar>(); }
+
+        // Draws minimal samples until the solver accepts one, redrawing degenerate ones a few times
+        template <typename Sampler>
+        bool drawHypothesis(Sampler& source, Model& model) const {
+            std::array<size_t, kSampleSize> sample;
+            std::array<Vector3, kSampleSize> sample_points;
+
+            for (int attempt = 0; attempt < 10; attempt++) {
+                if (!source.sample(sample)) return false;
+
+                for (size_t k = 0; k < kSampleSize; k++) sample_points[k] = point(sample[k]);
+                if (Policy::solve(sample_points, model) && model.isValid()) return true;
+            }
+            return false;
+        }
+
+        // SPRT needs the points in random order and the caller's memory is read-only, so it works
+        // on its own shuffled structure-of-arrays copy of the residual view. Scoring only counts,
+        // so order is free.
+        void buildSPRTOrder() {
+            const size_t n = data.size();
+            sprt_x.resize(n);
+            sprt_y.resize(n);
+            sprt_z.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                sprt_x[i] = residuals.x(i);
+                sprt_y[i] = residuals.y(i);
+                sprt_z[i] = residuals.z(i);
+            }
+
+            std::mt19937 shuffle_rng(std::random_device{}());
+            for (size_t i = n; i > 1; i--) {
+                size_t j = std::uniform_int_distribution<size_t>(0, i - 1)(shuffle_rng);
+                std::swap(sprt_x[i - 1], sprt_x[j]);
+                std::swap(sprt_y[i - 1], sprt_y[j]);
+                std::swap(sprt_z[i - 1], sprt_z[j]);
+            }
+        }
+
+        // Iterations needed for the target confidence, once min_consensus is reached
+        // acceptance is the probability that a good hypothesis survives verification
+        int iterationBound(int inliersCount, double acceptance = 1.0) const {
+            if (inliersCount < min_consensus) return max_iterations;
+            double population = point_weights ? total_weight : static_cast<double>(data.size());
+            double inlier_ratio = static_cast<double>(inliersCount) / population;
+            return requiredIterationsFor(std::pow(inlier_ratio, kSampleSize) * acceptance, confidence, max_iterations);
+        }
+
+        // Sequential loops draw through here, so PROSAC or NAPSAC replace uniform sampling when enabled
+        bool drawNext(Model& model) {
+            if (use_prosac) return drawHypothesis(prosac, model);
+            if (use_napsac) return drawHypothesis(napsac, model);
+            if (point_weights) return drawHypothesis(weighted_sampler, model);
+            return drawHypothesis(sampler, model);
+        }
+
+        // Iteration bound after a new best: PROSAC's stopping rule, or the standard one
+        int boundFor(const Model& best, int inliersCount, double acceptance = 1.0) {
+            if (!use_prosac) return iterationBound(inliersCount, acceptance);
+            if (inliersCount < min_consensus) return max_iterations;
+
+            prosac_flags.resize(data.size());
+            for (size_t i = 0; i < data.size(); i++) prosac_flags[i] = residual(best, point(i)) < error_tolerance;
+            return prosac.terminationBound(prosac_flags, confidence, prosac_beta, max_iterations);
+        }
+
+        // Final model fitting with best consensus set 
+        Model refine(const Model& bestHypothesis, int bestInliersCount) {
+            if (bestInliersCount >= static_cast<int>(kSampleSize)) {
+                collectInliers(bestHypothesis, inliers);
+                Model finalModel = fitModel(inliers);
+                if (finalModel.isValid()) return finalModel;
+            }
+            
+            inliers.clear();
+            std::cerr << "RANSAC failed to find a valid consensus set." << std::endl;
+            return Model();
+        }
+
+    public:
+        RansacEngine(Vec<InputPoint> points, Scalar error_tolerance, int max_iterations, int min_consensus, double confidence = 0.99)
+        : RansacEngine(PointView(), error_tolerance, max_iterations, min_consensus, confidence) {
+            owned_points = std::make_shared<const Vec<InputPoint>>(std::move(points));
+            setPoints(PointView::of(*owned_points));
+        }
+
+        // Runs on caller-owned points without copying or converting them: any PointView layout
+        // (AoS/SoA, float/double, interleaved records, a memory-mapped PointCloud) is scored in place.
+        // The memory behind the view must outlive the estimator.
+        RansacEngine(const PointView& points, Scalar error_tolerance, int max_iterations, int min_consensus, double confidence = 0.99)
+        : error_tolerance(error_tolerance), max_iterations(max_iterations), 
+          min_consensus(min_consensus), confidence(confidence) {
+            setPoints(points);
+        }
+
+        // Replacing the points drops a PROSAC ordering and any weights, which described the old ones
+        void setPoints(const PointView& points) {
+            data = points;
+            residuals = Policy::residualView(data);
+            sampler = UniformSampler(data.size(), std::random_device{}());
+            use_prosac = false;
+            point_weights = nullptr;
+            weighted_sampler = WeightedSampler();
+
+            if (use_napsac) napsac = NapsacSampler(data, napsac_options, std::random_device{}());
+            if (use_culling) octree.build(residuals, culling_leaf_size);
+            if (use_sprt) buildSPRTOrder();
+        }
+        
+        Model run() {
+            if (data.size() < kSampleSize) {
+                std::cerr << "Insufficient data points for " << Policy::kName << " fitting." << std::endl;
+                return Model();
+            }
+
+            lo_runs = 0;
+            if (use_prosac) prosac.reset();
+            if (use_napsac) napsac.reset();
+            const bool partitioned = scoring_pool != nullptr && data.size() >= partition_min_points;
+            if (scoring != ScoringMethod::Count || point_weights) return runScored(partitioned);
+            if (batch_size > 0 && !use_sprt && !use_culling) return runBatched(partitioned);
+
+            Model bestHypothesis;
+            int bestInliersCount = scoreSeeds(bestHypothesis);
+
+            // Shrinks as better models are found, once min_consensus is reached
+            int iteration_limit = max_iterations;
+            if (bestInliersCount > 0) {
+                if (use_sprt) {
+                    sprt.onNewBest(bestInliersCount, data.size());
+                    iteration_limit = boundFor(bestHypothesis, bestInliersCount, sprt.acceptanceProbability());
+                } else {
+                    iteration_limit = boundFor(bestHypothesis, bestInliersCount);
+                }
+            }
+
+            for (iterations = 0; iterations < iteration_limit; iterations++) {
+                Model currentModel;
+                if (!drawNext(currentModel)) continue;
+
+                // Score current model by its inlier count
+                int currentInliersCount;
+                if (use_sprt) currentInliersCount = countInliersSPRT(currentModel);
+                else if (use_culling) currentInliersCount = countInliers(currentModel);
+                else if (partitioned) currentInliersCount = countInliersPartitioned(currentModel);
+                else currentInliersCount = countInliers(currentModel);
+
+                // Only update if we found more inliers 
+                if (currentInliersCount > bestInliersCount) {
+                    bestInliersCount = currentInliersCount;
+                    bestHypothesis = currentModel;
+                    if (use_lo) {
+                        double bestQuality = bestInliersCount;
+                        localOptimize(bestHypothesis, bestQuality);
+                        bestInliersCount = static_cast<int>(bestQuality);
+                    }
+
+                    // Adaptive termination from the observed inlier ratio
+                    if (use_sprt) {
+                        sprt.onNewBest(bestInliersCount, data.size());
+                        iteration_limit = boundFor(bestHypothesis, bestInliersCount, sprt.acceptanceProbability());
+                    } else {
+                        iteration_limit = boundFor(bestHypothesis, bestInliersCount);
+                    }
+                }
+            }
+
+            return refine(bestHypothesis, bestInliersCount);
+        }
+
+        // Same search as run(), spread over the pool's workers. Each worker draws from its own
+        // RNG stream and keeps its own best; the best count and the iteration bound are shared
+        // through atomics so every worker stops as soon as the adaptive limit is reached.
+        Model runParallel(ThreadPool& pool) {
+            if (data.size() < kSampleSize) {
+                std::cerr << "Insufficient data points for " << Policy::kName << " fitting." << std::endl;
+                return Model();
+            }
+
+            struct alignas(64) WorkerBest {
+                Model model;
+                int count = 0;
+            };
+            Vec<WorkerBest> workerBest(pool.size());
+
+            std::atomic<int> next_iteration(0), drawn(0), best_count(0);
+            std::atomic<int> iteration_limit(max_iterations);
+            const unsigned int base_seed = std::random_device{}();
+
+            pool.parallelFor(workerBest.size(), [&](size_t w) {
+                std::seed_seq stream{base_seed, static_cast<unsigned int>(w)};
+                unsigned int worker_seed;
+                stream.generate(&worker_seed, &worker_seed + 1);
+                UniformSampler local(data.size(), worker_seed);
+                WeightedSampler local_weighted;
+                if (point_weights) {
+                    local_weighted = weighted_sampler;
+                    local_weighted.seed(worker_seed);
+                }
+                WorkerBest &mine = workerBest[w];
+
+                while (next_iteration.fetch_add(1, std::memory_order_relaxed) < iteration_limit.load(std::memory_order_relaxed)) {
+                    drawn.fetch_add(1, std::memory_order_relaxed);
+
+                    Model currentModel;
+                    bool drawn_ok = point_weights ? drawHypothesis(local_weighted, currentModel) : drawHypothesis(local, currentModel);
+                    if (!drawn_ok) continue;
+
+                    int currentInliersCount = countInliers(currentModel);
+                    if (currentInliersCount <= mine.count) continue;
+                    mine.model = currentModel;
+                    mine.count = currentInliersCount;
+
+                    // Publish a new global best and tighten the shared bound
+                    int global = best_count.load(std::memory_order_relaxed);
+                    while (currentInliersCount > global &&
+                           !best_count.compare_exchange_weak(global, currentInliersCount, std::memory_order_relaxed)) {}
+                    if (currentInliersCount <= global) continue;
+
+                    int bound = iterationBound(currentInliersCount);
+                    int limit = iteration_limit.load(std::memory_order_relaxed);
+                    while (bound < limit && !iteration_limit.compare_exchange_weak(limit, bound, std::memory_order_relaxed)) {}
+                }
+            });
+
+            iterations = drawn.load();
+
+            const WorkerBest *best = &workerBest[0];
+            for (const auto &candidate : workerBest) if (candidate.count > best->count) best = &candidate;
+            return refine(best->model, best->count);
+        }
+
+        // Preemptive RANSAC (Nister): a fixed set of hypotheses is scored breadth-first on blocks of
+        // random points and halved after every block, until one is left, the points run out, or a
+        // time / evaluation budget is hit. Always returns the current best hypothesis, so the
+        // worst-case latency is bounded by the budget. See getPreemptiveReport() for what was used.
+        Model runPreemptive(const PreemptiveOptions& options = PreemptiveOptions()) {
+            using Clock = std::chrono::steady_clock;
+            const auto start = Clock::now();
+            auto elapsedMs = [&] { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+            auto outOfTime = [&] { return options.time_budget_ms > 0 && elapsedMs() >= options.time_budget_ms; };
+
+            preemptive_report = PreemptiveReport();
+            inliers.clear();
+            if (data.size() < kSampleSize) {
+                std::cerr << "Insufficient data points for " << Policy::kName << " fitting." << std::endl;
+                return Model();
+            }
+            if (options.hypotheses < 1) {
+                std::cerr << "Preemptive " << Policy::kName << " RANSAC needs at least one hypothesis." << std::endl;
+                return Model();
+            }
+
+            struct Candidate {
+                Model model;
+                size_t score = 0;
+            };
+            Vec<Candidate> candidates;
+            // A time budget may stop generation long before a very large hypothesis count
+            candidates.reserve(std::min<size_t>(options.hypotheses, 1 << 12));
+            for (iterations = 0; iterations < options.hypotheses && !outOfTime(); iterations++) {
+                Candidate candidate;
+                if (drawHypothesis(sampler, candidate.model)) candidates.push_back(candidate);
+            }
+            if (candidates.empty()) return Model();
+
+            // Each block is gathered once into a small SoA buffer and scored by every survivor
+            const size_t block = std::max<size_t>(1, options.block_size);
+            block_x.resize(block);
+            block_y.resize(block);
+            block_z.resize(block);
+            const PointView block_view = PointView::soa(block_x.data(), block_y.data(), block_z.data(), block);
+
+            size_t alive = candidates.size();
+            size_t scored_points = 0;
+            bool exhausted = false;
+            while (alive > 1 && scored_points < data.size()) {
+                // Shrink the last block to whatever the evaluation budget still allows
+                size_t len = block;
+                if (options.evaluation_budget > 0) {
+                    len = std::min(len, (options.evaluation_budget - preemptive_report.evaluations) / alive);
+                }
+                if (len == 0 || outOfTime()) {
+                    exhausted = true;
+                    break;
+                }
+
+                for (size_t k = 0; k < len; k++) {
+                    size_t idx = sampler.index();
+                    block_x[k] = static_cast<Scalar>(residuals.x(idx));
+                    block_y[k] = static_cast<Scalar>(residuals.y(idx));
+                    block_z[k] = static_cast<Scalar>(residuals.z(idx));
+                }
+                // All survivors are scored on the block in one batched pass
+                block_planes.resize(4 * alive);
+                block_counts.resize(alive);
+                for (size_t h = 0; h < alive; h++) packPlane(block_planes, h, candidates[h].model);
+                countPlaneInliersBatch<Scalar>(block_view, 0, len, block_planes.data(), alive, error_tolerance, block_counts.data());
+                for (size_t h = 0; h < alive; h++) candidates[h].score += block_counts[h];
+                preemptive_report.evaluations += alive * len;
+                preemptive_report.blocks++;
+                scored_points += len;
+
+                // Keep the better half
+                size_t keep = std::max<size_t>(1, alive / 2);
+                std::nth_element(candidates.begin(), candidates.begin() + (keep - 1), candidates.begin() + alive,
+                                 [](const Candidate &l, const Candidate &r) { return l.score > r.score; });
+                alive = keep;
+            }
+
+            auto best = std::max_element(candidates.begin(), candidates.begin() + alive,
+                                         [](const Candidate &l, const Candidate &r) { return l.score < r.score; });
+
+            preemptive_report.hypotheses = static_cast<int>(candidates.size());
+            preemptive_report.survivors = static_cast<int>(alive);
+            preemptive_report.budget_exhausted = exhausted;
+            preemptive_report.elapsed_ms = elapsedMs();
+
+            Model result = best->model;
+            if (options.refine) {
+                collectInliers(best->model, inliers);
+                Model fitted = fitModel(inliers);
+                if (fitted.isValid()) result = fitted;
+            }
+            return result;
+        }
+
+        const PreemptiveReport& getPreemptiveReport() const { return preemptive_report; }
+
+        // Samples in run() with PROSAC: order lists point indices from the most to the least
+        // promising (see prosacOrder() to sort by a per-point quality score). The pool grows from
+        // the top of the ranking and run() stops on PROSAC's criterion. beta is the probability
+        // that a point agrees with a wrong model. runParallel() and runPreemptive() stay uniform.
+        void enablePROSAC(Vec<size_t> order, double beta = 0.05) {
+            if (order.size() != data.size()) {
+                std::cerr << "PROSAC ordering has " << order.size() << " entries for " << data.size() << " points." << std::endl;
+                return;
+            }
+            use_prosac = true;
+            use_napsac = false;
+            prosac_beta = beta;
+            prosac = ProsacSampler(std::move(order), kSampleSize, std::random_device{}());
+        }
+
+        void disablePROSAC() { use_prosac = false; }
+
+        // Samples in run() with NAPSAC: the second and third points come from within
+        // options.radius of the first, which makes all-inlier samples far more likely on scenes
+        // with many planes (see NapsacOptions for the progressive P-NAPSAC variant). The voxel grid
+        // is built here and again by setPoints(). Replaces PROSAC; runParallel() and
+        // runPreemptive() stay uniform.
+        void enableNAPSAC(const NapsacOptions& options = NapsacOptions()) {
+            use_napsac = true;
+            use_prosac = false;
+            napsac_options = options;
+            napsac = NapsacSampler(data, napsac_options, std::random_device{}());
+        }
+
+        void disableNAPSAC() {
+            use_napsac = false;
+            napsac = NapsacSampler();
+        }
+
+        // Selects how run() compares hypotheses (see Scoring.hpp). Count keeps the inlier count and
+        // every fast path; MSAC, MLESAC and MAGSAC rank by a robust loss, which breaks ties between
+        // equal counts in favour of tighter fits. Batched scoring and SPRT only count, so run()
+        // ignores them under a loss. gamma is the MLESAC inlier mixing weight.
+        void setScoring(ScoringMethod method, double gamma = 0.5) {
+            scoring = method;
+            mlesac_gamma = gamma;
+        }
+
+        ScoringMethod getScoring() const { return scoring; }
+
+        // Gives every point a weight, e.g. the number of input points a downsampled point stands
+        // for: run() then draws samples in proportion to weight, counts inliers by total weight and
+        // weights losses the same way, so min_consensus and the iteration bound are in input points.
+        // weights holds one entry per point, is caller-owned like the points and must outlive the
+        // estimator; nullptr clears it. Weighted runs take the scored path, so batched scoring and
+        // SPRT are not used. runParallel() samples, counts and bounds by weight as well (each worker
+        // copies the cumulative weights); runPreemptive() ignores the weights.
+        void setWeights(const Scalar* weights) {
+            point_weights = weights;
+            total_weight = 0;
+            weighted_sampler = WeightedSampler();
+            if (!weights) return;
+            for (size_t i = 0; i < data.size(); i++) total_weight += weights[i];
+            weighted_sampler = WeightedSampler(weights, data.size(), std::random_device{}());
+        }
+
+        // Runs a local optimization step (see LocalOptimizationOptions) whenever run() finds a new
+        // best model. Fewer outer iterations are needed since the bound tightens from the
+        // optimized inlier count. Not used by runParallel() or runPreemptive().
+        void enableLocalOptimization(const LocalOptimizationOptions& options = LocalOptimizationOptions()) {
+            use_lo = true;
+            lo_options = options;
+        }
+
+        void disableLocalOptimization() {
+            use_lo = false;
+            Vec<Vector3>().swap(lo_points);
+        }
+
+        // Local optimization steps run by the last run()
+        int getLocalOptimizations() const { return lo_runs; }
+
+        // Lets run() score each hypothesis across the pool, chunk_size points per task, whenever
+        // the cloud has at least min_points points. Smaller clouds keep the single-threaded scan.
+        void enablePartitionedScoring(ThreadPool& pool, size_t min_points = 1 << 20, size_t chunk_size = 1 << 15) {
+            scoring_pool = &pool;
+            partition_min_points = min_points;
+            chunk_points = std::max<size_t>(1, chunk_size);
+        }
+
+        void disablePartitionedScoring() { scoring_pool = nullptr; }
+
+        // Lets run() draw hypotheses batch_size at a time and score each batch in one cache-blocked
+        // pass over the points (see countPlaneInliersBatch()). Combines with partitioned scoring;
+        // SPRT takes precedence since it abandons hypotheses individually. 32-128 is a good range.
+        void enableBatchedScoring(size_t batch = 64) {
+            batch_size = std::max<size_t>(1, batch);
+            batch_models.resize(batch_size);
+            batch_planes.resize(4 * batch_size);
+        }
+
+        void disableBatchedScoring() { batch_size = 0; }
+
+        // Hypotheses every run() scores before drawing any sample, e.g. the models found in the
+        // previous frame of a sequence. The best of them starts the run as its best model, so the
+        // iteration bound is tight from the first draw when one is still good. Kept until replaced;
+        // an empty list clears them. Not used by runParallel() or runPreemptive().
+        void setInitialHypotheses(Vec<Model> hypotheses) {
+            seeds.clear();
+            for (Model& hypothesis : hypotheses) if (hypothesis.isValid()) seeds.push_back(std::move(hypothesis));
+        }
+
+        // Counts inliers in run() on an octree of the points (see PointOctree), accepting or
+        // rejecting whole cells by their bounding box and scanning only the leaves that straddle
+        // the tolerance band. Pays off on large structured scenes, where a hypothesis touches a few
+        // hundred boxes instead of every point; costs a Morton-ordered copy of the points, rebuilt
+        // by setPoints(). Takes precedence over batched and partitioned counting; SPRT and weights
+        // take precedence over it, and robust losses do not use it.
+        void enableSpatialCulling(size_t leaf_size = 128) {
+            use_culling = true;
+            culling_leaf_size = std::max<size_t>(1, leaf_size);
+            octree.build(residuals, culling_leaf_size);
+        }
+
+        void disableSpatialCulling() {
+            use_culling = false;
+            octree = PointOctree<Scalar>();
+        }
+
+        // Verifies hypotheses in run() with the sequential probability ratio test instead of a full
+        // scan. epsilon and delta are the initial inlier ratio and the initial probability that a
+        // point agrees with a bad model; both adapt during the run. Takes precedence over
+        // partitioned scoring. Keeps a shuffled copy of the points so blocks are random samples.
+        void enableSPRT(double epsilon = 0.1, double delta = 0.01) {
+            use_sprt = true;
+            sprt = SPRT(epsilon, delta);
+            buildSPRTOrder();
+        }
+
+        void disableSPRT() {
+            use_sprt = false;
+            Vec<Scalar>().swap(sprt_x);
+            Vec<Scalar>().swap(sprt_y);
+            Vec<Scalar>().swap(sprt_z);
+        }
+
+        // Indices into the input points of the consensus set found by the last run()
+        const Vec<size_t>& getInliers() const { return inliers; }
+
+        // Number of hypotheses drawn by the last run()
+        int getIterations() const { return iterations; }
+
+        // Method to evaluate model quality
+        double evaluateModel(const Model& model) const {
+            if (!model.isValid()) return 1e10;
+            
+            double total_error = 0.0;
+            int inlier_count = 0;
+            
+            for (size_t i = 0; i < data.size(); i++) {
+                double dist = residual(model, point(i));
+                if (dist < error_tolerance) {
+                    total_error += dist;
+                    inlier_count++;
+                }
+            }
+            
+            if (inlier_count == 0) return 1e10;
+            return total_error / inlier_count; 
+        }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Sequential probability ratio test for hypothesis verification (Matas & Chum, R-RANSAC with SPRT).
+// epsilon is the probability that a point is consistent with a good model, delta the probability
+// that it is consistent with a bad one. The likelihood ratio is accumulated in log space, block by
+// block, and a model is rejected once it exceeds log(A). Both parameters are re-estimated online:
+// epsilon from each new best model, delta from the consistent fraction seen on rejected models.
+class SPRT{
+    public:
+        // model_cost is the time to generate one hypothesis, in units of one point verification
+        SPRT(double epsilon = 0.1, double delta = 0.01, double model_cost = 200)
+            : epsilon(epsilon), delta(delta), model_cost(model_cost) { recompute(); }
+
+        double getEpsilon() const { return epsilon; }
+        double getDelta() const { return delta; }
+        double getThreshold() const { return A; }
+
+        // Log-likelihood ratio contribution of `tested` points, `consistent` of which are inliers
+        double blockLogRatio(size_t consistent, size_t tested) const {
+            return consistent * log_consistent + (tested - consistent) * log_inconsistent;
+        }
+
+        bool reject(double log_lambda) const { return log_lambda > log_A; }
+
+        // Probability that a good model survives the test, used for the termination bound
+        double acceptanceProbability() const { return 1.0 - 1.0 / A; }
+
+        void onRejected(size_t consistent, size_t tested){
+            if (tested == 0) return;
+            delta_sum += static_cast<double>(consistent) / tested;
+            rejected++;
+
+            double estimate = std::max(delta_sum / rejected, 1e-6);
+            if (std::abs(estimate - delta) > 0.05 * delta) {
+                delta = estimate;
+                recompute();
+            }
+        }
+
+        void onNewBest(size_t inliers, size_t total){
+            if (total == 0) return;
+            epsilon = static_cast<double>(inliers) / total;
+            recompute();
+        }
+
+    private:
+        double epsilon, delta, model_cost;
+        double A = 0, log_A = 0;
+        double log_consistent = 0, log_inconsistent = 0;
+        double delta_sum = 0;
+        size_t rejected = 0;
+
+        void recompute(){
+            // The test only separates good from bad models while delta < epsilon
+            if (!(delta < epsilon) || epsilon >= 1) {
+                A = log_A = std::numeric_limits<double>::infinity();
+                log_consistent = log_inconsistent = 0;
+                return;
+            }
+
+            log_consistent = std::log(delta / epsilon);
+            log_inconsistent = std::log((1 - delta) / (1 - epsilon));
+
+            // A is the fixed point of A = K + log(A), K = t_M * C + 1 (one model per sample)
+            double C = (1 - delta) * log_inconsistent + delta * log_consistent;
+            double K = model_cost * C + 1;
+            A = K;
+            for (int i = 0; i < 10; i++) A = K + std::log(A);
+            log_A = std::log(A);
+        }
+};
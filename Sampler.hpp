@@ -0,0 +1,314 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <random>
+#include "Common.hpp"
+#include "Termination.hpp"
+#include "PointView.hpp"
+#include "VoxelGrid.hpp"
+
+// Draws k distinct indices out of [0, n) by rejection sampling.
+// k is the minimal sample size (2 for a line, 3 for a plane), so a redraw only
+// happens on a collision and the expected cost per sample is O(1) regardless of n.
+// The generator and distribution are kept between calls, nothing is allocated per draw.
+class UniformSampler{
+    public:
+        UniformSampler() = default;
+
+        UniformSampler(size_t n, unsigned int seed) : rng(seed) { reset(n); }
+
+        void reset(size_t n){
+            size = n;
+            if (n > 0) dist = std::uniform_int_distribution<size_t>(0, n - 1);
+        }
+
+        void seed(unsigned int s) { rng.seed(s); }
+
+        size_t populationSize() const { return size; }
+
+        // A single index, e.g. for drawing random evaluation points
+        size_t index() { return dist(rng); }
+
+        // Fills out with K distinct indices. Returns false if the population is too small.
+        template <size_t K>
+        bool sample(std::array<size_t, K> &out){
+            if (size < K) return false;
+
+            for (size_t i = 0; i < K; i++){
+                bool duplicate;
+                do {
+                    out[i] = dist(rng);
+                    duplicate = false;
+                    for (size_t j = 0; j < i; j++) if (out[j] == out[i]) { duplicate = true; break; }
+                } while (duplicate);
+            }
+            return true;
+        }
+
+    private:
+        std::mt19937 rng;
+        std::uniform_int_distribution<size_t> dist;
+        size_t size = 0;
+};
+
+// Draws k distinct indices with probability proportional to per-point weights, by inverting the
+// cumulative weights with a binary search (O(log n) per index). Used on weighted clouds, where a
+// weight counts the input points a point stands for, so that a sample has the same chance of
+// being all-inlier as on the input cloud.
+class WeightedSampler{
+    public:
+        WeightedSampler() = default;
+
+        template <typename T>
+        WeightedSampler(const T *weights, size_t n, unsigned int seed) : rng(seed), cumulative(n) {
+            double total = 0;
+            for (size_t i = 0; i < n; i++) cumulative[i] = total += std::max(static_cast<double>(weights[i]), 0.0);
+            if (total > 0) dist = std::uniform_real_distribution<double>(0.0, total);
+        }
+
+        void seed(unsigned int s) { rng.seed(s); }
+
+        size_t populationSize() const { return cumulative.size(); }
+
+        size_t index() {
+            size_t i = std::upper_bound(cumulative.begin(), cumulative.end(), dist(rng)) - cumulative.begin();
+            return std::min(i, cumulative.size() - 1);
+        }
+
+        // Fills out with K distinct indices. Returns false if fewer than K points have a weight.
+        template <size_t K>
+        bool sample(std::array<size_t, K> &out){
+            if (cumulative.size() < K || cumulative.back() <= 0) return false;
+
+            for (size_t i = 0; i < K; i++){
+                bool duplicate;
+                int attempts = 0;
+                do {
+                    if (++attempts > 64) return false;
+                    out[i] = index();
+                    duplicate = false;
+                    for (size_t j = 0; j < i; j++) if (out[j] == out[i]) { duplicate = true; break; }
+                } while (duplicate);
+            }
+            return true;
+        }
+
+    private:
+        std::mt19937 rng;
+        Vec<double> cumulative;
+        std::uniform_real_distribution<double> dist;
+};
+
+// Point indices sorted from the highest to the lowest quality, the ordering ProsacSampler expects
+template <typename T>
+inline Vec<size_t> prosacOrder(const Vec<T> &quality){
+    Vec<size_t> order(quality.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    std::stable_sort(order.begin(), order.end(), [&](size_t l, size_t r) { return quality[l] > quality[r]; });
+    return order;
+}
+
+// PROSAC (Chum & Matas): draws from the top-ranked points first and grows the pool towards the
+// whole set on the schedule under which it becomes uniform sampling after growth_samples draws.
+// order[0] is the most promising point; sample() returns indices into the original points.
+// The pool grows by one point per draw at first, so good hypotheses from well-ranked points come
+// within the first few dozen draws.
+class ProsacSampler{
+    public:
+        ProsacSampler() = default;
+
+        ProsacSampler(Vec<size_t> order, size_t sample_size, unsigned int seed, double growth_samples = 200000)
+            : order(std::move(order)), m(sample_size), growth_samples(growth_samples), rng(seed) { reset(); }
+
+        // Restarts the schedule from the m best points
+        void reset(){
+            const size_t N = order.size();
+            t = 0;
+            n = std::min(m, N);
+            limit = N;
+            Tn_prime = 1;
+            Tn = growth_samples;
+            for (size_t i = 0; i < m && i < N; i++) Tn *= static_cast<double>(m - i) / static_cast<double>(N - i);
+        }
+
+        void seed(unsigned int s) { rng.seed(s); }
+
+        size_t populationSize() const { return order.size(); }
+
+        // Size of the pool the next sample is drawn from
+        size_t poolSize() const { return n; }
+
+        template <size_t K>
+        bool sample(std::array<size_t, K> &out){
+            if (K != m || order.size() < K) return false;
+
+            t++;
+            if (t > Tn_prime && n < limit) {
+                double Tn_next = Tn * static_cast<double>(n + 1) / static_cast<double>(n + 1 - m);
+                Tn_prime += static_cast<size_t>(std::ceil(Tn_next - Tn));
+                Tn = Tn_next;
+                n++;
+            }
+
+            // Once the schedule has caught up, sample the pool uniformly; otherwise the newest
+            // point is always in the sample and the rest come from the points ranked above it
+            size_t drawn = 0;
+            size_t pool = n;
+            if (Tn_prime >= t) {
+                out[drawn++] = n - 1;
+                pool = n - 1;
+            }
+            std::uniform_int_distribution<size_t> dist(0, pool - 1);
+            for (size_t i = drawn; i < K; i++) {
+                bool duplicate;
+                do {
+                    out[i] = dist(rng);
+                    duplicate = false;
+                    for (size_t j = 0; j < i; j++) if (out[j] == out[i]) { duplicate = true; break; }
+                } while (duplicate);
+            }
+            for (size_t i = 0; i < K; i++) out[i] = order[out[i]];
+            return true;
+        }
+
+        // PROSAC stopping rule for the current best model, whose inliers are flagged by point index.
+        // Among the pool sizes n whose inlier count I_n is unlikely to come from a bad model (beta
+        // is the probability that a random point agrees with one), picks the n* that needs the fewest
+        // samples to draw an all-inlier sample from the first n* points with probability confidence.
+        // The pool stops growing past n*; returns that number of samples.
+        int terminationBound(const Vec<unsigned char> &is_inlier, double confidence, double beta, int max_iterations){
+            const size_t N = order.size();
+            int best_bound = max_iterations;
+            size_t best_n = N;
+            size_t inliers = 0;
+
+            for (size_t size = 1; size <= N; size++) {
+                if (!is_inlier[order[size - 1]]) continue;
+                inliers++;
+                if (size < m) continue;
+
+                // Non-randomness: I_n above the binomial(n, beta) tail, normal approximation at 5%
+                double mean = size * beta;
+                double minimum = m + mean + std::sqrt(2.706 * mean * (1.0 - beta));
+                if (inliers < minimum) continue;
+
+                double all_inlier = 1.0;
+                for (size_t j = 0; j < m; j++) all_inlier *= static_cast<double>(inliers - j) / static_cast<double>(size - j);
+                int bound = requiredIterationsFor(all_inlier, confidence, max_iterations);
+                if (bound < best_bound || (bound == best_bound && size > best_n)) {
+                    best_bound = bound;
+                    best_n = size;
+                }
+            }
+
+            limit = std::max(best_n, n);
+            return best_bound;
+        }
+
+    private:
+        Vec<size_t> order;
+        size_t m = 0;
+        double growth_samples = 200000;
+        std::mt19937 rng;
+
+        size_t t = 0;           // samples drawn
+        size_t n = 0;           // current pool: the n best points
+        size_t limit = 0;       // the pool does not grow past this (n* once known)
+        size_t Tn_prime = 1;    // draw at which the pool grows next
+        double Tn = 0;          // expected all-inlier draws from the pool under uniform sampling
+};
+
+// Settings for NapsacSampler
+struct NapsacOptions{
+    double radius = 0.5;            // neighbourhood radius, in the units of the points
+    bool progressive = false;       // P-NAPSAC: widen the neighbourhood as sampling goes on
+    double growth = 2.0;            // radius factor from one level to the next
+    int levels = 4;                 // neighbourhood sizes tried before sampling globally
+    size_t samples_per_level = 64;  // samples drawn at each level
+};
+
+// NAPSAC (Nasuto & Craddock): the first point is drawn uniformly, the others from the points
+// within radius of it, so on a scene of many planes the whole sample usually lies on one of
+// them. Neighbourhoods come from voxel grids with cells as large as the radius, built once per
+// cloud. The progressive variant (after P-NAPSAC, Barath et al.) starts at radius, multiplies it
+// by growth every samples_per_level samples and, once all levels are used, samples globally like
+// UniformSampler; grids for the wider levels are built on first use. A seed whose neighbourhood
+// is too small is redrawn.
+class NapsacSampler{
+    public:
+        NapsacSampler() = default;
+
+        NapsacSampler(const PointView& points, const NapsacOptions& options, unsigned int seed)
+            : points(points), options(options), uniform(points.size(), seed), rng(seed) {
+            grids.resize(options.progressive ? std::max(1, options.levels) : 1);
+            reset();
+        }
+
+        void reset() { t = 0; }
+
+        void seed(unsigned int s) {
+            rng.seed(s);
+            uniform.seed(s + 1);
+        }
+
+        size_t populationSize() const { return points.size(); }
+
+        // Neighbourhood radius of the next sample; 0 once sampling is global
+        double currentRadius() const {
+            if (!options.progressive) return options.radius;
+            size_t level = t / std::max<size_t>(1, options.samples_per_level);
+            if (level >= grids.size()) return 0;
+            return options.radius * std::pow(options.growth, static_cast<double>(level));
+        }
+
+        template <size_t K>
+        bool sample(std::array<size_t, K> &out){
+            if (points.size() < K) return false;
+
+            const double radius = currentRadius();
+            const size_t level = options.progressive ? t / std::max<size_t>(1, options.samples_per_level) : 0;
+            t++;
+            if (radius <= 0) return uniform.sample(out);
+
+            VoxelGrid& grid = grids[level];
+            if (grid.empty()) grid = VoxelGrid(points, radius);
+
+            const double radius2 = radius * radius;
+            for (int attempt = 0; attempt < 16; attempt++) {
+                const size_t first = uniform.index();
+                const Point3d centre = points[first];
+
+                neighbours.clear();
+                grid.forEachNear(centre, radius, [&](size_t i) {
+                    if (i != first && (points[i] - centre).squaredNorm() <= radius2) neighbours.push_back(i);
+                });
+                if (neighbours.size() < K - 1) continue;
+
+                out[0] = first;
+                std::uniform_int_distribution<size_t> dist(0, neighbours.size() - 1);
+                for (size_t i = 1; i < K; i++) {
+                    bool duplicate;
+                    do {
+                        out[i] = neighbours[dist(rng)];
+                        duplicate = false;
+                        for (size_t j = 1; j < i; j++) if (out[j] == out[i]) { duplicate = true; break; }
+                    } while (duplicate);
+                }
+                return true;
+            }
+            return false;
+        }
+
+    private:
+        PointView points;
+        NapsacOptions options;
+        UniformSampler uniform;
+        std::mt19937 rng;
+        Vec<VoxelGrid> grids;    // one per level, built on first use
+        Vec<size_t> neighbours;
+        size_t t = 0;
+};
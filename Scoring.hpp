@@ -0,0 +1,294 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include "PointView.hpp"
+#include "PlaneKernels.hpp"
+
+// Model scoring policies. Counting inliers ties often (especially on quantized data) and does
+// not tell a model that fits its inliers tightly from one that barely scrapes them, so the
+// estimators can instead minimise a robust loss over the point-to-model residuals r:
+//   Count   1 for r >= t, else 0 (the number of outliers, equivalent to counting inliers)
+//   MSAC    min(r^2, t^2), the truncated quadratic (Torr & Zisserman)
+//   MLESAC  negative log-likelihood of a Gaussian inlier / uniform outlier mixture (Torr & Zisserman)
+//   MAGSAC  MAGSAC++ loss, the noise scale marginalised over [0, sigma_max] (Barath et al.)
+// Every policy is a function of r^2 and the kernels are instantiated per policy, so the loss is
+// inlined into the scoring loop; the method itself is chosen at runtime. MLESAC and MAGSAC need
+// exp/log or special functions, so both are tabulated in r^2 once per run and interpolated.
+enum class ScoringMethod { Count, MSAC, MLESAC, MAGSAC };
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RANSAC_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define RANSAC_ALWAYS_INLINE inline
+#endif
+
+constexpr size_t kLossTableSize = 1024;
+
+// Precomputed constants for one tolerance t
+template <typename Scalar>
+struct LossParams{
+    Scalar threshold2 = 0;          // t^2
+    // MLESAC / MAGSAC: the loss is piecewise linear in u = min(r^2 * table_scale, kLossTableSize),
+    // intercept[k] + u * slope[k] on segment k = floor(u). The last segment is the flat tail.
+    // Kept in double for float points too, where the lookups still vectorise as double gathers.
+    Vec<double> intercept, slope;
+    double table_scale = 0;
+};
+
+// MAGSAC++ loss for a one-dimensional residual with t = k * sigma_max, k = 2.576 (the 0.99
+// quantile). The per-point weight is the Gaussian likelihood marginalised over sigma in
+// [r / k, sigma_max], w(r) = integral of exp(-r^2 / 2 sigma^2) / sigma, and the loss is its
+// IRLS potential rho(r) = integral_0^r x w(x) dx, normalised so outliers cost 1. Sampled at
+// r^2 / t^2 = i / kLossTableSize and built once.
+inline const Vec<double>& magsacLossSamples(){
+    static const Vec<double> samples = [] {
+        constexpr double k = 2.576;
+        constexpr double sigma_max = 1.0 / k;
+        constexpr size_t r_steps = 2048, sigma_steps = 128;
+
+        auto weight = [&](double r) {
+            double lo = r / k, hi = sigma_max, h = (hi - lo) / sigma_steps, sum = 0;
+            if (h <= 0) return 0.0;
+            for (size_t s = 0; s <= sigma_steps; s++) {
+                double sigma = std::max(lo + s * h, 1e-12);
+                double f = std::exp(-r * r / (2 * sigma * sigma)) / sigma;
+                sum += (s == 0 || s == sigma_steps) ? f / 2 : f;
+            }
+            return sum * h;
+        };
+
+        // Cumulative trapezoid of x w(x) on a uniform grid in r
+        Vec<double> rho(r_steps + 1, 0.0);
+        double previous = 0;
+        for (size_t i = 1; i <= r_steps; i++) {
+            double r = static_cast<double>(i) / r_steps;
+            double current = r * weight(r);
+            rho[i] = rho[i - 1] + (previous + current) / (2.0 * r_steps);
+            previous = current;
+        }
+
+        Vec<double> out(kLossTableSize + 1);
+        for (size_t i = 0; i <= kLossTableSize; i++) {
+            double position = std::sqrt(static_cast<double>(i) / kLossTableSize) * r_steps;
+            size_t lower = std::min(static_cast<size_t>(position), r_steps - 1);
+            double frac = position - lower;
+            out[i] = (rho[lower] + frac * (rho[lower + 1] - rho[lower])) / rho[r_steps];
+        }
+        return out;
+    }();
+    return samples;
+}
+
+// Turns kLossTableSize + 1 uniform samples over [0, end) of r^2 into the segment form of
+// LossParams; the last sample is the loss for every r^2 >= end
+template <typename Scalar>
+inline void tabulateLoss(LossParams<Scalar> &params, const Vec<double> &samples, double end){
+    params.intercept.resize(kLossTableSize + 1);
+    params.slope.resize(kLossTableSize + 1);
+    for (size_t k = 0; k < kLossTableSize; k++) {
+        double rise = samples[k + 1] - samples[k];
+        params.slope[k] = rise;
+        params.intercept[k] = samples[k] - rise * k;
+    }
+    params.slope[kLossTableSize] = 0;
+    params.intercept[kLossTableSize] = samples[kLossTableSize];
+    params.table_scale = kLossTableSize / end;
+}
+
+// gamma is the MLESAC mixing weight (expected inlier ratio), outlier_range the extent nu of the
+// uniform outlier distribution, e.g. the diameter of the cloud
+template <typename Scalar>
+inline LossParams<Scalar> makeLossParams(ScoringMethod method, Scalar tolerance,
+                                         double gamma = 0.5, double outlier_range = 1.0){
+    LossParams<Scalar> params;
+    params.threshold2 = tolerance * tolerance;
+
+    if (method == ScoringMethod::MLESAC) {
+        // -log(gamma N(r; 0, sigma) + (1 - gamma) / nu) with sigma = t / 1.96. Past `end` the
+        // Gaussian term is below 1e-6 of the outlier density and the loss is flat.
+        const double sigma = static_cast<double>(tolerance) / 1.96;
+        const double mix = std::min(std::max(gamma, 1e-6), 1.0 - 1e-6);
+        const double inlier = mix / (std::sqrt(2.0 * 3.14159265358979323846) * sigma);
+        const double outlier = (1.0 - mix) / std::max(outlier_range, 1e-12);
+        const double end = 2.0 * sigma * sigma * std::log(std::max(inlier / outlier, 1.0) * 1e6);
+
+        Vec<double> samples(kLossTableSize + 1);
+        for (size_t i = 0; i < kLossTableSize; i++) {
+            double r2 = end * i / kLossTableSize;
+            samples[i] = -std::log(inlier * std::exp(-r2 / (2.0 * sigma * sigma)) + outlier);
+        }
+        samples[kLossTableSize] = -std::log(outlier);
+        tabulateLoss(params, samples, end);
+    }
+    if (method == ScoringMethod::MAGSAC) tabulateLoss(params, magsacLossSamples(), static_cast<double>(params.threshold2));
+    return params;
+}
+
+struct CountLoss{
+    template <typename Scalar>
+    static RANSAC_ALWAYS_INLINE Scalar loss(Scalar r2, const LossParams<Scalar> &p) { return r2 < p.threshold2 ? Scalar(0) : Scalar(1); }
+};
+
+struct MSACLoss{
+    template <typename Scalar>
+    static RANSAC_ALWAYS_INLINE Scalar loss(Scalar r2, const LossParams<Scalar> &p) { return std::min(r2, p.threshold2); }
+};
+
+// Segment lookup in the table built by makeLossParams(). No branches and no int-to-float
+// conversion, so the compiler turns the two lookups into gathers.
+template <typename Scalar>
+RANSAC_ALWAYS_INLINE Scalar tabulatedLoss(Scalar r2, const LossParams<Scalar> &p){
+    double u = std::min(static_cast<double>(kLossTableSize), static_cast<double>(r2) * p.table_scale);
+    int segment = static_cast<int>(u);
+    return static_cast<Scalar>(p.intercept.data()[segment] + u * p.slope.data()[segment]);
+}
+
+struct MLESACLoss{
+    template <typename Scalar>
+    static RANSAC_ALWAYS_INLINE Scalar loss(Scalar r2, const LossParams<Scalar> &p) { return tabulatedLoss(r2, p); }
+};
+
+struct MagsacLoss{
+    template <typename Scalar>
+    static RANSAC_ALWAYS_INLINE Scalar loss(Scalar r2, const LossParams<Scalar> &p) { return tabulatedLoss(r2, p); }
+};
+
+template <typename Scalar>
+using PlaneLossKernel = double (*)(const Scalar *x, const Scalar *y, const Scalar *z, const Scalar *w, size_t n,
+                                  Scalar a, Scalar b, Scalar c, Scalar d, const LossParams<Scalar> &params);
+
+// Sum of Loss over the residuals of contiguous points. The losses of a tile are first written
+// to a buffer (independent per point, so the loop vectorises, table gathers included) and then
+// summed with one partial sum per lane, which vectorises without reassociating floating-point
+// adds. A non-null w scales each loss by the point's weight. Shared by every target below.
+template <typename Loss, typename Scalar>
+RANSAC_ALWAYS_INLINE double planeLossBody(const Scalar *x, const Scalar *y, const Scalar *z, const Scalar *w, size_t n,
+                                          Scalar a, Scalar b, Scalar c, Scalar d, const LossParams<Scalar> &params){
+    constexpr size_t W = 64 / sizeof(Scalar);
+    alignas(64) Scalar losses[kPlaneTilePoints];
+
+    double total = 0;
+    for (size_t start = 0; start < n; start += kPlaneTilePoints) {
+        const size_t len = std::min(kPlaneTilePoints, n - start);
+        const Scalar *px = x + start, *py = y + start, *pz = z + start;
+        if (w) {
+            const Scalar *pw = w + start;
+            for (size_t i = 0; i < len; i++) {
+                Scalar r = a * px[i] + b * py[i] + c * pz[i] + d;
+                losses[i] = Loss::loss(r * r, params) * pw[i];
+            }
+        } else {
+            for (size_t i = 0; i < len; i++) {
+                Scalar r = a * px[i] + b * py[i] + c * pz[i] + d;
+                losses[i] = Loss::loss(r * r, params);
+            }
+        }
+
+        Scalar lanes[W] = {};
+        size_t i = 0;
+        for (; i + W <= len; i += W) {
+            for (size_t j = 0; j < W; j++) lanes[j] += losses[i + j];
+        }
+        for (; i < len; i++) total += losses[i];
+        for (size_t j = 0; j < W; j++) total += lanes[j];
+    }
+    return total;
+}
+
+template <typename Loss, typename Scalar>
+inline double planeLossTile(const Scalar *x, const Scalar *y, const Scalar *z, const Scalar *w, size_t n,
+                            Scalar a, Scalar b, Scalar c, Scalar d, const LossParams<Scalar> &params){
+    return planeLossBody<Loss, Scalar>(x, y, z, w, n, a, b, c, d, params);
+}
+
+#if RANSAC_X86_DISPATCH
+
+template <typename Loss, typename Scalar>
+__attribute__((target("avx2")))
+inline double planeLossTileAVX2(const Scalar *x, const Scalar *y, const Scalar *z, const Scalar *w, size_t n,
+                                Scalar a, Scalar b, Scalar c, Scalar d, const LossParams<Scalar> &params){
+    return planeLossBody<Loss, Scalar>(x, y, z, w, n, a, b, c, d, params);
+}
+
+template <typename Loss, typename Scalar>
+__attribute__((target("avx512f")))
+inline double planeLossTileAVX512(const Scalar *x, const Scalar *y, const Scalar *z, const Scalar *w, size_t n,
+                                  Scalar a, Scalar b, Scalar c, Scalar d, const LossParams<Scalar> &params){
+    return planeLossBody<Loss, Scalar>(x, y, z, w, n, a, b, c, d, params);
+}
+
+#endif
+
+template <typename Loss, typename Scalar>
+inline PlaneLossKernel<Scalar> selectPlaneLossKernel(const char **name = nullptr){
+#if RANSAC_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        if (name) *name = "avx512";
+        return planeLossTileAVX512<Loss, Scalar>;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        if (name) *name = "avx2";
+        return planeLossTileAVX2<Loss, Scalar>;
+    }
+#endif
+    if (name) *name = "scalar";
+    return planeLossTile<Loss, Scalar>;
+}
+
+// Total Loss of the plane (a, b, c, d) over points [begin, begin + n) of a view, whatever its
+// layout. Structure-of-arrays Scalar data is scored in place, anything else one tile at a time.
+// weights, if given, holds one weight per point of the view (not per point of the range).
+template <typename Loss, typename Scalar>
+inline double planeLoss(const PointView &points, size_t begin, size_t n,
+                        Scalar a, Scalar b, Scalar c, Scalar d, const LossParams<Scalar> &params,
+                        const Scalar *weights = nullptr){
+    static const PlaneLossKernel<Scalar> kernel = selectPlaneLossKernel<Loss, Scalar>();
+
+    const size_t stride = points.byteStride();
+    const bool in_place = stride == sizeof(Scalar) && points.scalarType() == scalarTypeOf<Scalar>() && points.zBytes();
+    alignas(64) Scalar tile[3][kPlaneTilePoints];
+
+    double total = 0;
+    for (size_t start = begin, end = begin + n; start < end; start += kPlaneTilePoints) {
+        const size_t len = std::min(kPlaneTilePoints, end - start);
+        const size_t offset = start * stride;
+        const unsigned char *xb = points.xBytes() + offset;
+        const unsigned char *yb = points.yBytes() + offset;
+        const unsigned char *zb = points.zBytes() ? points.zBytes() + offset : nullptr;
+        const Scalar *wb = weights ? weights + start : nullptr;
+
+        if (in_place) {
+            total += kernel(reinterpret_cast<const Scalar*>(xb), reinterpret_cast<const Scalar*>(yb),
+                            reinterpret_cast<const Scalar*>(zb), wb, len, a, b, c, d, params);
+            continue;
+        }
+        if (points.scalarType() == ScalarType::Float32) {
+            gatherTile<float, Scalar>(xb, stride, len, tile[0]);
+            gatherTile<float, Scalar>(yb, stride, len, tile[1]);
+            gatherTile<float, Scalar>(zb, stride, len, tile[2]);
+        } else {
+            gatherTile<double, Scalar>(xb, stride, len, tile[0]);
+            gatherTile<double, Scalar>(yb, stride, len, tile[1]);
+            gatherTile<double, Scalar>(zb, stride, len, tile[2]);
+        }
+        total += kernel(tile[0], tile[1], tile[2], wb, len, a, b, c, d, params);
+    }
+    return total;
+}
+
+// Runtime selection of the policy; each branch is a separately instantiated kernel
+template <typename Scalar>
+inline double planeLoss(ScoringMethod method, const PointView &points, size_t begin, size_t n,
+                        Scalar a, Scalar b, Scalar c, Scalar d, const LossParams<Scalar> &params,
+                        const Scalar *weights = nullptr){
+    switch (method) {
+        case ScoringMethod::MSAC:   return planeLoss<MSACLoss, Scalar>(points, begin, n, a, b, c, d, params, weights);
+        case ScoringMethod::MLESAC: return planeLoss<MLESACLoss, Scalar>(points, begin, n, a, b, c, d, params, weights);
+        case ScoringMethod::MAGSAC: return planeLoss<MagsacLoss, Scalar>(points, begin, n, a, b, c, d, params, weights);
+        case ScoringMethod::Count:  break;
+    }
+    return planeLoss<CountLoss, Scalar>(points, begin, n, a, b, c, d, params, weights);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include "Common.hpp"
+#include "PointView.hpp"
+
+// Sliding-window RANSAC over a point stream. Samples go into a fixed-capacity ring buffer that
+// is stored twice, so the live window is always one contiguous structure-of-arrays range and
+// the estimator runs on it in place. Between searches the model is maintained incrementally:
+// each new sample is checked against it and, if it is an inlier, added to the least-squares
+// moments of the inliers, from which the model is refitted in O(1); evicted inliers are removed
+// the same way. The window is searched again only when the inliers fall below min_consensus or
+// the inlier ratio below keep_ratio times the ratio the last search found, and at most once per
+// capacity / 16 samples. The moments are rebuilt from the window once per capacity samples, so
+// rounding cannot build up over a long stream; outside searches a sample costs O(1) amortized.
+//
+// Policy supplies Scalar, Model, Estimator (a RANSAC constructible from a PointView, with
+// setPoints(), run() and getInliers()), Moments, kSampleSize, and static distance(), add(),
+// remove(), fittable() and fit(); see StreamingLine.hpp and StreamingPlane.hpp.
+template <typename Policy>
+class StreamingRANSAC{
+    public:
+        using Scalar = typename Policy::Scalar;
+        using Model = typename Policy::Model;
+        using Estimator = typename Policy::Estimator;
+
+        StreamingRANSAC(size_t capacity, Scalar tolerance, int max_iterations, int min_consensus,
+                        double confidence = 0.99, double keep_ratio = 0.8)
+            : solver(PointView(), tolerance, max_iterations, min_consensus, confidence),
+              capacity(std::max<size_t>(1, capacity)), tolerance(tolerance),
+              min_consensus(static_cast<size_t>(std::max(min_consensus, 0))), keep_ratio(keep_ratio),
+              search_gap(std::max<size_t>(1, this->capacity / 16)), since_search(search_gap) {
+            xs.assign(2 * this->capacity, Scalar(0));
+            ys.assign(2 * this->capacity, Scalar(0));
+            zs.assign(2 * this->capacity, Scalar(0));
+            flags.assign(this->capacity, 0);
+        }
+
+        // Move-only: solver views the window in xs, ys and zs
+        StreamingRANSAC(const StreamingRANSAC&) = delete;
+        StreamingRANSAC& operator=(const StreamingRANSAC&) = delete;
+        StreamingRANSAC(StreamingRANSAC&&) = default;
+        StreamingRANSAC& operator=(StreamingRANSAC&&) = default;
+
+        // Appends a sample, evicting the oldest once the window is full. z is ignored for lines.
+        void push(Scalar x, Scalar y, Scalar z = 0) {
+            if (count == capacity) evict();
+
+            const size_t slot = (start + count) % capacity;
+            xs[slot] = xs[slot + capacity] = x;
+            ys[slot] = ys[slot + capacity] = y;
+            zs[slot] = zs[slot + capacity] = z;
+            flags[slot] = has_model && Policy::distance(current, x, y, z) < tolerance;
+            if (flags[slot]) {
+                Policy::add(moments, x, y, z);
+                refit();
+            }
+            count++;
+            since_search++;
+            since_rebuild++;
+            maintain();
+        }
+
+        // Drops the oldest sample
+        void pop() {
+            if (count == 0) return;
+            evict();
+            maintain();
+        }
+
+        void clear() {
+            start = count = 0;
+            moments.clear();
+            has_model = false;
+            current = Model();
+            since_search = search_gap;
+            since_rebuild = 0;
+        }
+
+        // The samples in the window, oldest first
+        PointView window() const { return PointView::soa(xs.data() + start, ys.data() + start, zs.data() + start, count); }
+
+        size_t size() const { return count; }
+
+        bool hasModel() const { return has_model; }
+
+        // Least-squares fit of the current inliers
+        const Model& model() const { return current; }
+
+        // Samples in the window that were inliers of the model when they arrived or at the last search
+        size_t inlierCount() const { return moments.count(); }
+
+        // Searches run so far
+        int getSearches() const { return searches; }
+
+        // The estimator behind the searches, e.g. to change its scoring
+        Estimator& estimator() { return solver; }
+
+    private:
+        Estimator solver;
+        size_t capacity;
+        Scalar tolerance;
+        size_t min_consensus;
+        double keep_ratio;
+        size_t search_gap;
+
+        Vec<Scalar> xs, ys, zs;         // 2 * capacity: slot i is mirrored at i + capacity
+        Vec<unsigned char> flags;       // inlier flag per slot
+        size_t start = 0, count = 0;
+
+        typename Policy::Moments moments;
+        Model current;
+        bool has_model = false;
+        double reference_ratio = 0;    // inlier ratio found by the last search
+        int searches = 0;
+        size_t since_search;
+        size_t since_rebuild = 0;
+
+        void evict() {
+            if (flags[start]) {
+                Policy::remove(moments, xs[start], ys[start], zs[start]);
+                refit();
+            }
+            start = (start + 1) % capacity;
+            count--;
+        }
+
+        void refit() {
+            if (Policy::fittable(moments)) current = Policy::fit(moments);
+        }
+
+        void maintain() {
+            if (since_rebuild >= capacity) rebuildMoments();
+
+            const size_t inliers = moments.count();
+            const bool weak = !has_model || inliers < min_consensus ||
+                              static_cast<double>(inliers) < keep_ratio * reference_ratio * static_cast<double>(count);
+            if (weak && count >= Policy::kSampleSize && count >= min_consensus && since_search >= search_gap) search();
+        }
+
+        void search() {
+            searches++;
+            since_search = 0;
+            solver.setPoints(window());
+            Model found = solver.run();
+
+            const Vec<size_t>& inliers = solver.getInliers();
+            if (inliers.size() < Policy::kSampleSize) return;
+
+            std::fill(flags.begin(), flags.end(), 0);
+            for (size_t i : inliers) flags[(start + i) % capacity] = 1;
+            rebuildMoments();
+
+            current = found;
+            has_model = true;
+            reference_ratio = static_cast<double>(inliers.size()) / static_cast<double>(count);
+        }
+
+        void rebuildMoments() {
+            moments.clear();
+            for (size_t i = start; i < start + count; i++) {
+                if (flags[i % capacity]) Policy::add(moments, xs[i], ys[i], zs[i]);
+            }
+            since_rebuild = 0;
+        }
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "LineFit.hpp"
+#include "RANSAC_line.hpp"
+#include "Streaming.hpp"
+
+// Line policy for StreamingRANSAC: vertical residuals and the least-squares refit of LinePolicy
+template <typename Scalar_ = double, typename Accumulator = double>
+struct LineStreamPolicy{
+    using Scalar = Scalar_;
+    using Model = LineModelT<Scalar>;
+    using Estimator = LineRANSAC<Scalar, Accumulator>;
+    using Moments = LineMoments<Accumulator>;
+    static constexpr size_t kSampleSize = 2;
+
+    static Scalar distance(const Model& model, Scalar x, Scalar y, Scalar) { return model.computeError({x, y}); }
+    static void add(Moments& moments, Scalar x, Scalar y, Scalar) { moments.add(x, y); }
+    static void remove(Moments& moments, Scalar x, Scalar y, Scalar) { moments.remove(x, y); }
+    static bool fittable(const Moments& moments) { return moments.valid(); }
+
+    static Model fit(const Moments& moments) { return LinePolicy<Scalar, Accumulator>::fit(moments); }
+};
+
+// Sliding-window line fit over a stream of (x, y) samples, e.g. a trend over a rolling sensor window
+template <typename Scalar = double, typename Accumulator = double>
+using StreamingLineRANSAC = StreamingRANSAC<LineStreamPolicy<Scalar, Accumulator>>;
+
+#ifdef RANSAC_PREBUILT
+extern template class StreamingRANSAC<LineStreamPolicy<double, double>>;
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "PlaneFit.hpp"
+#include "RANSAC_plane.hpp"
+#include "Streaming.hpp"
+
+// Plane policy for StreamingRANSAC: point-to-plane distances and the 3x3 scatter of the inliers
+template <typename Scalar_ = double, typename Accumulator = double>
+struct PlaneStreamPolicy{
+    using Scalar = Scalar_;
+    using Model = PlaneModelT<Scalar>;
+    using Estimator = PlaneRANSAC<Scalar, Accumulator>;
+    using Moments = PlaneScatter<Accumulator>;
+    using Vector3 = Eigen::Matrix<Accumulator, 3, 1>;
+    static constexpr size_t kSampleSize = 3;
+
+    static Scalar distance(const Model& model, Scalar x, Scalar y, Scalar z) {
+        return std::abs(model.a * x + model.b * y + model.c * z + model.d);
+    }
+    static void add(Moments& moments, Scalar x, Scalar y, Scalar z) { moments.add(Vector3(x, y, z)); }
+    static void remove(Moments& moments, Scalar x, Scalar y, Scalar z) { moments.remove(Vector3(x, y, z)); }
+    static bool fittable(const Moments& moments) { return moments.count() >= 3; }
+
+    static Model fit(const Moments& moments) { return PlanePolicy<Scalar, Accumulator>::fit(moments); }
+};
+
+// Sliding-window plane fit over a stream of 3D samples
+template <typename Scalar = double, typename Accumulator = double>
+using StreamingPlaneRANSAC = StreamingRANSAC<PlaneStreamPolicy<Scalar, Accumulator>>;
+
+#ifdef RANSAC_PREBUILT
+extern template class StreamingRANSAC<PlaneStreamPolicy<double, double>>;
+#endif
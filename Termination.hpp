@@ -0,0 +1,28 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// Number of iterations needed to see at least one successful iteration with probability
+// confidence, when each iteration independently succeeds with success_probability.
+// Clamped to [1, max_iterations].
+inline int requiredIterationsFor(double success_probability, double confidence, int max_iterations){
+    if (success_probability <= 0) return max_iterations;
+    if (success_probability >= 1) return std::min(1, max_iterations);
+
+    double log_fail = std::log(1.0 - success_probability);
+    if (log_fail >= 0) return max_iterations;    // success_probability underflowed
+
+    double n = std::ceil(std::log(1.0 - confidence) / log_fail);
+    if (!(n < max_iterations)) return max_iterations;
+    return std::max(1, static_cast<int>(n));
+}
+
+// Standard RANSAC stopping rule: the number of iterations needed to draw at least one
+// all-inlier sample of size sample_size with probability confidence, given the current
+// inlier ratio. Clamped to [1, max_iterations].
+inline int requiredIterations(double inlier_ratio, int sample_size, double confidence, int max_iterations){
+    if (inlier_ratio <= 0) return max_iterations;
+    if (inlier_ratio >= 1) return std::min(1, max_iterations);
+    return requiredIterationsFor(std::pow(inlier_ratio, sample_size), confidence, max_iterations);
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent work-stealing pool. Every worker owns a deque: it pops its own work from
+// the back and steals from the front of the others when it runs dry. Threads are
+// started once and reused across RANSAC runs.
+class ThreadPool{
+    public:
+        using Task = std::function<void()>;
+
+        explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency()){
+            num_threads = std::max<size_t>(1, num_threads);
+            queues.reserve(num_threads);
+            for (size_t i = 0; i < num_threads; i++) queues.emplace_back(new WorkQueue());
+            workers.reserve(num_threads);
+            for (size_t i = 0; i < num_threads; i++) workers.emplace_back([this, i] { workerLoop(i); });
+        }
+
+        ~ThreadPool(){
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto &worker : workers) worker.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t size() const { return workers.size(); }
+
+        void submit(Task task){
+            size_t target = next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+            // Counted before it is queued: a worker may pop and uncount it before this returns
+            pending.fetch_add(1, std::memory_order_release);
+            {
+                std::lock_guard<std::mutex> lock(queues[target]->mutex);
+                queues[target]->tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleep_mutex);
+            }
+            wake.notify_one();
+        }
+
+        // Runs fn(i) for i in [0, count) and blocks until all calls returned.
+        // The calling thread executes queued tasks while it waits, so nested use is safe.
+        template <typename F>
+        void parallelFor(size_t count, F fn){
+            if (count == 0) return;
+
+            std::atomic<size_t> remaining(count);
+            for (size_t i = 0; i < count; i++) {
+                submit([&fn, &remaining, i] {
+                    fn(i);
+                    remaining.fetch_sub(1, std::memory_order_acq_rel);
+                });
+            }
+
+            while (remaining.load(std::memory_order_acquire) > 0) {
+                if (!runOne(next_queue.load(std::memory_order_relaxed))) std::this_thread::yield();
+            }
+        }
+
+    private:
+        struct WorkQueue{
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues;
+        std::vector<std::thread> workers;
+        std::atomic<size_t> next_queue{0};
+        std::atomic<size_t> pending{0};
+
+        std::mutex sleep_mutex;
+        std::condition_variable wake;
+        bool stopping = false;
+
+        bool popOwn(size_t id, Task &task){
+            WorkQueue &queue = *queues[id];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) return false;
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+
+        bool steal(size_t thief, Task &task){
+            for (size_t k = 1; k <= queues.size(); k++) {
+                WorkQueue &queue = *queues[(thief + k) % queues.size()];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.tasks.empty()) continue;
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+                return true;
+            }
+            return false;
+        }
+
+        bool runOne(size_t id){
+            Task task;
+            if (!popOwn(id % queues.size(), task) && !steal(id, task)) return false;
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+            task();
+            return true;
+        }
+
+        void workerLoop(size_t id){
+            while (true) {
+                if (runOne(id)) continue;
+
+                std::unique_lock<std::mutex> lock(sleep_mutex);
+                wake.wait(lock, [this] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+                if (stopping && pending.load(std::memory_order_acquire) == 0) return;
+            }
+        }
+};
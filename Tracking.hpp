@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include "Common.hpp"
+#include "PointView.hpp"
+#include "PlaneFit.hpp"
+#include "RANSAC_plane.hpp"
+
+// Tracks the dominant plane through a sequence of frames of mostly the same scene, e.g. a depth
+// camera. The plane of the previous frame is verified on the new one in a single pass that
+// counts its inliers and accumulates their scatter, and the plane refitted from that scatter is
+// this frame's answer. Only when its support falls below keep_ratio of the previous frame's
+// (or below min_consensus) does the estimator run, with the tracked plane as its first
+// hypothesis. The estimator and its buffers persist across frames; frames are not copied.
+template <typename Scalar = double, typename Accumulator = double>
+class PlaneTracker{
+    public:
+        using Model = PlaneModelT<Scalar>;
+
+        PlaneTracker(Scalar error_tolerance, int max_iterations, int min_consensus, double confidence = 0.99,
+                     double keep_ratio = 0.8)
+            : solver(PointView(), error_tolerance, max_iterations, min_consensus, confidence),
+              error_tolerance(error_tolerance), min_consensus(min_consensus), keep_ratio(keep_ratio) {}
+
+        // Plane of the next frame; invalid if neither tracking nor the search finds one
+        Model track(const PointView& frame) {
+            searched = true;
+            if (tracked.isValid() && verify(frame)) {
+                searched = false;
+                return tracked;
+            }
+
+            solver.setPoints(frame);
+            solver.setInitialHypotheses(tracked.isValid() ? Vec<Model>{tracked} : Vec<Model>());
+            tracked = solver.run();
+            inliers = solver.getInliers();
+            support = inliers.size();
+            return tracked;
+        }
+
+        // Forgets the tracked plane, e.g. after a cut in the sequence
+        void reset() {
+            tracked = Model();
+            support = 0;
+            inliers.clear();
+        }
+
+        const Model& model() const { return tracked; }
+
+        // Indices into the last frame of the tracked plane's inliers
+        const Vec<size_t>& getInliers() const { return inliers; }
+
+        // Whether the last frame needed the full search
+        bool lastFrameSearched() const { return searched; }
+
+        // The estimator behind the fallback search, e.g. to enable SPRT or culling
+        PlaneRANSAC<Scalar, Accumulator>& estimator() { return solver; }
+
+    private:
+        PlaneRANSAC<Scalar, Accumulator> solver;
+        Scalar error_tolerance;
+        int min_consensus;
+        double keep_ratio;
+
+        Model tracked;
+        size_t support = 0;
+        Vec<size_t> inliers, candidates;    // candidates: inliers of the frame being verified
+        PlaneScatter<Accumulator> scatter;
+        bool searched = true;
+
+        // Classifies the frame against the tracked plane and refits it on the inliers. Keeps the
+        // previous inliers untouched and returns false when the support dropped.
+        bool verify(const PointView& frame) {
+            scatter.clear();
+            candidates.clear();
+            for (size_t i = 0; i < frame.size(); i++) {
+                Point3d p = frame[i];
+                if (tracked.computeDistance(p.template cast<Scalar>()) >= error_tolerance) continue;
+                candidates.push_back(i);
+                scatter.add(p.template cast<Accumulator>());
+            }
+
+            const size_t count = candidates.size();
+            if (count < 3 || count < static_cast<size_t>(std::max(min_consensus, 0)) ||
+                static_cast<double>(count) < keep_ratio * static_cast<double>(support)) return false;
+
+            Model refit = PlanePolicy<Scalar, Accumulator>::fit(scatter);
+            if (!refit.isValid()) return false;
+
+            tracked = refit;
+            support = count;
+            inliers.swap(candidates);
+            return true;
+        }
+};
+
+#ifdef RANSAC_PREBUILT
+extern template class PlaneTracker<double, double>;
+#endif
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include "Common.hpp"
+#include "PointView.hpp"
+
+// Stable LSD radix sort of (key, index) pairs on the key, 11 bits per pass. Each pass starts at
+// the lowest key bit not yet sorted that differs between keys, so unused high bits cost nothing:
+// VoxelGrid keys of a cloud up to 2048 cells wide on every axis sort in 3 passes. scratch is
+// resized to keyed's size, so callers sorting repeatedly can keep it.
+inline void radixSortByKey(Vec<Pair<uint64_t, size_t>>& keyed, Vec<Pair<uint64_t, size_t>>& scratch) {
+    constexpr int kDigitBits = 11;
+    constexpr uint64_t kDigitMask = (uint64_t(1) << kDigitBits) - 1;
+
+    if (keyed.empty()) return;
+
+    uint64_t varying = 0;
+    for (const auto& entry : keyed) varying |= entry.first ^ keyed[0].first;
+
+    scratch.resize(keyed.size());
+    Vec<size_t> offsets(kDigitMask + 1);
+    for (int shift = 0; shift < 64 && (varying >> shift) != 0; shift += kDigitBits) {
+        while (((varying >> shift) & 1) == 0) shift++;
+
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (const auto& entry : keyed) offsets[(entry.first >> shift) & kDigitMask]++;
+        size_t total = 0;
+        for (size_t& offset : offsets) {
+            size_t count = offset;
+            offset = total;
+            total += count;
+        }
+        for (const auto& entry : keyed) scratch[offsets[(entry.first >> shift) & kDigitMask]++] = entry;
+        keyed.swap(scratch);
+    }
+}
+
+inline void radixSortByKey(Vec<Pair<uint64_t, size_t>>& keyed) {
+    Vec<Pair<uint64_t, size_t>> scratch;
+    radixSortByKey(keyed, scratch);
+}
+
+// Sparse voxel grid over a point cloud, built once in O(n) with a radix sort. Point indices are
+// stored sorted by cell, in increasing order within a cell, so every occupied cell is one
+// contiguous range of indices(); a hash map finds the cell of any position. Cell coordinates are
+// packed 21 bits per axis relative to the bounding-box minimum, so clouds wider than 2^21 cells
+// on an axis wrap around (distant cells then share a key, which costs extra candidates in
+// neighbourhood queries but never misses one).
+class VoxelGrid{
+    public:
+        struct Cell{
+            uint64_t key;
+            size_t begin;
+            size_t end;
+
+            size_t size() const { return end - begin; }
+        };
+
+        VoxelGrid() = default;
+
+        VoxelGrid(const PointView& points, double cell_size) : cell(std::max(cell_size, 1e-12)) {
+            const size_t n = points.size();
+            if (n == 0) return;
+
+            origin = points[0];
+            for (size_t i = 1; i < n; i++) origin = origin.cwiseMin(points[i]);
+
+            Vec<Pair<uint64_t, size_t>> keyed(n);
+            for (size_t i = 0; i < n; i++) keyed[i] = {keyOf(points[i]), i};
+            radixSortByKey(keyed);
+
+            order.resize(n);
+            for (size_t i = 0; i < n; i++) {
+                order[i] = keyed[i].second;
+                if (i == 0 || keyed[i].first != keyed[i - 1].first) {
+                    if (!cells.empty()) cells.back().end = i;
+                    cells.push_back({keyed[i].first, i, n});
+                }
+            }
+
+            lookup.reserve(cells.size());
+            for (size_t c = 0; c < cells.size(); c++) lookup.emplace(cells[c].key, c);
+        }
+
+        double cellSize() const { return cell; }
+        bool empty() const { return cells.empty(); }
+
+        // Occupied cells in key order, each a range of indices()
+        const Vec<Cell>& occupiedCells() const { return cells; }
+
+        // Point indices grouped by cell
+        const Vec<size_t>& indices() const { return order; }
+
+        // Calls fn(index) for every point in the cells overlapping the cube of half-width radius
+        // around p; the caller filters by exact distance if needed
+        template <typename Fn>
+        void forEachNear(const Point3d& p, double radius, Fn fn) const {
+            const long long reach = static_cast<long long>(std::ceil(radius / cell));
+            const long long cx = coordinate(p.x(), origin.x());
+            const long long cy = coordinate(p.y(), origin.y());
+            const long long cz = coordinate(p.z(), origin.z());
+
+            for (long long x = cx - reach; x <= cx + reach; x++) {
+                for (long long y = cy - reach; y <= cy + reach; y++) {
+                    for (long long z = cz - reach; z <= cz + reach; z++) {
+                        auto found = lookup.find(pack(x, y, z));
+                        if (found == lookup.end()) continue;
+                        const Cell& c = cells[found->second];
+                        for (size_t i = c.begin; i < c.end; i++) fn(order[i]);
+                    }
+                }
+            }
+        }
+
+        uint64_t keyOf(const Point3d& p) const {
+            return pack(coordinate(p.x(), origin.x()), coordinate(p.y(), origin.y()), coordinate(p.z(), origin.z()));
+        }
+
+    private:
+        double cell = 1.0;
+        Point3d origin = Point3d::Zero();
+        Vec<Cell> cells;
+        Vec<size_t> order;
+        std::unordered_map<uint64_t, size_t> lookup;
+
+        long long coordinate(double v, double o) const { return static_cast<long long>(std::floor((v - o) / cell)); }
+
+        static uint64_t pack(long long x, long long y, long long z) {
+            const uint64_t mask = (uint64_t(1) << 21) - 1;
+            return (static_cast<uint64_t>(x) & mask) | ((static_cast<uint64_t>(y) & mask) << 21) |
+                   ((static_cast<uint64_t>(z) & mask) << 42);
+        }
+};
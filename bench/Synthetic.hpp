@@ -0,0 +1,188 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include "../RANSAC_line.hpp"
+#include "../RANSAC_plane.hpp"
+
+// Configurations that break the minimal solvers on purpose
+enum class Degeneracy {
+    None,
+    Collinear,     // plane inliers lie on one line inside the plane; line inliers share one x
+    Duplicates     // inliers collapse onto a handful of repeated positions
+};
+
+struct SyntheticOptions{
+    size_t points = 100000;
+    double outlier_ratio = 0.5;
+    double noise = 0.01;          // standard deviation of the inlier residual
+    size_t structures = 1;        // lines or planes; inliers are split evenly between them
+    Degeneracy degeneracy = Degeneracy::None;
+    double extent = 10;           // half-width of the sampled region
+    uint64_t seed = 42;
+};
+
+// Labelled cloud with its ground truth. label[i] is the structure point i was drawn from, or -1
+// for an outlier. Points are stored as separate x, y, z arrays (z is 0 for lines).
+template <typename Model>
+struct SyntheticCloud{
+    Vec<double> x, y, z;
+    Vec<int> label;
+    Vec<Model> truth;
+    Vec<size_t> structure_size;
+
+    size_t size() const { return x.size(); }
+    PointView view() const { return PointView::soa(x.data(), y.data(), z.data(), x.size()); }
+
+    void resize(size_t n) {
+        x.assign(n, 0.0);
+        y.assign(n, 0.0);
+        z.assign(n, 0.0);
+        label.assign(n, -1);
+    }
+};
+
+// Generators are deterministic: the same options and seed give the same cloud (for a given
+// standard library, whose distributions are implementation-defined)
+namespace synthetic {
+
+// Every point independently becomes an outlier with probability outlier_ratio, otherwise an
+// inlier of a uniformly chosen structure, so structures have equal expected size
+inline int drawLabel(std::mt19937_64& rng, const SyntheticOptions& options) {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (options.structures == 0 || unit(rng) < options.outlier_ratio) return -1;
+    return static_cast<int>(std::uniform_int_distribution<size_t>(0, options.structures - 1)(rng));
+}
+
+inline void countStructures(const Vec<int>& label, Vec<size_t>& structure_size) {
+    for (int l : label) if (l >= 0) structure_size[l]++;
+}
+
+}
+
+// Lines y = m x + b with slopes in [-2, 2] and vertical Gaussian noise, matching the line
+// estimator's residual. Outliers are uniform over the box the lines span.
+inline SyntheticCloud<LineModel> makeLines(const SyntheticOptions& options) {
+    std::mt19937_64 rng(options.seed);
+    const double e = options.extent;
+    std::uniform_real_distribution<double> slope(-2.0, 2.0), offset(-e / 2, e / 2), along(-e, e), box(-3 * e, 3 * e);
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+
+    SyntheticCloud<LineModel> cloud;
+    for (size_t k = 0; k < options.structures; k++) {
+        double m = slope(rng);
+        cloud.truth.emplace_back(m, offset(rng));
+    }
+    cloud.structure_size.assign(options.structures, 0);
+
+    // Degenerate anchors: one x per structure, or eight positions per structure
+    Vec<double> anchor_x(options.structures);
+    for (double& x : anchor_x) x = along(rng);
+    Vec<Pair<double, double>> repeated;
+    for (size_t k = 0; k < options.structures; k++) {
+        for (int j = 0; j < 8; j++) {
+            double x = along(rng);
+            repeated.push_back({x, cloud.truth[k].m * x + cloud.truth[k].b});
+        }
+    }
+
+    cloud.resize(options.points);
+    for (size_t i = 0; i < options.points; i++) {
+        int l = synthetic::drawLabel(rng, options);
+        cloud.label[i] = l;
+        if (l < 0) {
+            cloud.x[i] = along(rng);
+            cloud.y[i] = box(rng);
+            continue;
+        }
+
+        const LineModel& line = cloud.truth[l];
+        switch (options.degeneracy) {
+            case Degeneracy::None:
+                cloud.x[i] = along(rng);
+                cloud.y[i] = line.m * cloud.x[i] + line.b + options.noise * gaussian(rng);
+                break;
+            case Degeneracy::Collinear:
+                cloud.x[i] = anchor_x[l];
+                cloud.y[i] = line.m * anchor_x[l] + line.b + along(rng);
+                break;
+            case Degeneracy::Duplicates: {
+                const auto& p = repeated[8 * l + std::uniform_int_distribution<int>(0, 7)(rng)];
+                cloud.x[i] = p.first;
+                cloud.y[i] = p.second;
+                break;
+            }
+        }
+    }
+    synthetic::countStructures(cloud.label, cloud.structure_size);
+    return cloud;
+}
+
+// Planes with uniformly random unit normals and offsets in [-extent / 2, extent / 2], sampled
+// over a square of side 2 extent around the point closest to the origin, with Gaussian noise
+// along the normal. Outliers are uniform over a cube of half-width 1.5 extent.
+inline SyntheticCloud<PlaneModel> makePlanes(const SyntheticOptions& options) {
+    std::mt19937_64 rng(options.seed);
+    const double e = options.extent;
+    std::uniform_real_distribution<double> offset(-e / 2, e / 2), along(-e, e), box(-1.5 * e, 1.5 * e);
+    std::normal_distribution<double> gaussian(0.0, 1.0);
+
+    // Draws are sequenced one per statement so the cloud does not depend on evaluation order
+    auto onPlane = [&](const Point3d& origin, const Point3d& u, const Point3d& v) {
+        double s = along(rng);
+        double t = along(rng);
+        return Point3d(origin + s * u + t * v);
+    };
+
+    struct Frame{
+        Point3d origin, u, v, normal;
+    };
+    Vec<Frame> frames;
+    SyntheticCloud<PlaneModel> cloud;
+    for (size_t k = 0; k < options.structures; k++) {
+        Point3d normal;
+        for (int axis = 0; axis < 3; axis++) normal[axis] = gaussian(rng);
+        normal.normalize();
+        double d = offset(rng);
+        Point3d u = normal.unitOrthogonal();
+        frames.push_back({-d * normal, u, normal.cross(u), normal});
+        cloud.truth.emplace_back(normal, -d * normal);
+    }
+    cloud.structure_size.assign(options.structures, 0);
+
+    Vec<Point3d> repeated;
+    for (const Frame& f : frames) {
+        for (int j = 0; j < 8; j++) repeated.push_back(onPlane(f.origin, f.u, f.v));
+    }
+
+    cloud.resize(options.points);
+    for (size_t i = 0; i < options.points; i++) {
+        int l = synthetic::drawLabel(rng, options);
+        cloud.label[i] = l;
+
+        Point3d p = Point3d::Zero();
+        if (l < 0) {
+            for (int axis = 0; axis < 3; axis++) p[axis] = box(rng);
+        } else {
+            const Frame& f = frames[l];
+            switch (options.degeneracy) {
+                case Degeneracy::None:
+                    p = onPlane(f.origin, f.u, f.v) + options.noise * gaussian(rng) * f.normal;
+                    break;
+                case Degeneracy::Collinear:
+                    p = onPlane(f.origin, f.u, Point3d::Zero()) + options.noise * gaussian(rng) * f.normal;
+                    break;
+                case Degeneracy::Duplicates:
+                    p = repeated[8 * l + std::uniform_int_distribution<int>(0, 7)(rng)];
+                    break;
+            }
+        }
+        cloud.x[i] = p.x();
+        cloud.y[i] = p.y();
+        cloud.z[i] = p.z();
+    }
+    synthetic::countStructures(cloud.label, cloud.structure_size);
+    return cloud;
+}
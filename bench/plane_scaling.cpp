@@ -0,0 +1,44 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include "../RANSAC_plane.hpp"
+
+// Thread scaling of PlaneRANSAC::runParallel on a synthetic plane with outliers.
+// Early termination is disabled (min_consensus > N) so every run draws max_iterations hypotheses.
+// Usage: RP_scaling [num_points] [max_threads] [iterations]
+int main(int argc, char **argv) {
+    size_t num_points = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    size_t max_threads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::thread::hardware_concurrency();
+    int iterations = argc > 3 ? std::atoi(argv[3]) : 200;
+    max_threads = std::max<size_t>(1, max_threads);
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> uniform(-10.0, 10.0);
+    std::normal_distribution<double> noise(0.0, 0.02);
+
+    Vec<Point3d> points;
+    points.reserve(num_points);
+    for (size_t i = 0; i < num_points; i++) {
+        double x = uniform(rng), y = uniform(rng);
+        if (i % 2 == 0) points.emplace_back(x, y, 2 * x + 0.5 * y + 1 + noise(rng));
+        else points.emplace_back(x, y, uniform(rng));
+    }
+
+    PlaneRANSAC<> solver(points, 0.1, iterations, static_cast<int>(num_points) + 1);
+
+    double baseline = 0;
+    std::cout << "threads,seconds,hypotheses_per_second,speedup" << std::endl;
+    for (size_t threads = 1; threads <= max_threads; threads++) {
+        ThreadPool pool(threads);
+
+        auto start = std::chrono::steady_clock::now();
+        solver.runParallel(pool);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (threads == 1) baseline = seconds;
+        std::cout << threads << "," << seconds << "," << solver.getIterations() / seconds << "," << baseline / seconds << std::endl;
+    }
+    return 0;
+}
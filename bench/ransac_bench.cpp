@@ -0,0 +1,358 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "../Ransac.hpp"
+#include "Synthetic.hpp"
+
+// Benchmark suite over synthetic lines and planes. Every combination of the listed settings is
+// generated once (deterministically from --seed) and solved --runs times per estimator variant;
+// the results go out as one JSON document, by default on stdout. kUsage lists the options.
+//
+// Throughput is nominal: points_scored_per_s counts every hypothesis against all N points, so
+// SPRT and culling show up as higher effective throughput. Accuracy compares the refitted model
+// with the structure that contributed most of its inliers.
+
+namespace {
+
+const char* kUsage =
+    "Usage: ransac_bench [--models line,plane] [--points 1e3,1e5,1e6] [--outliers 0.5] [--noise 0.01]\n"
+    "                    [--structures 1] [--degeneracy none,collinear,duplicates]\n"
+    "                    [--variants plain,batched,sprt,culling,lo,msac,parallel] [--runs 10]\n"
+    "                    [--iterations 10000] [--min-consensus 0] [--confidence 0.99]\n"
+    "                    [--tolerance 3*noise] [--threads hardware] [--seed 42] [--out results.json]\n"
+    "       ransac_bench --help\n";
+
+struct Settings{
+    Vec<std::string> models{"line", "plane"};
+    Vec<double> points{1e3, 1e5, 1e6};
+    Vec<double> outliers{0.5};
+    Vec<double> noise{0.01};
+    Vec<double> structures{1};
+    Vec<std::string> degeneracies{"none"};
+    Vec<std::string> variants{"plain"};
+    int runs = 10;
+    int iterations = 10000;
+    int min_consensus = 0;
+    double confidence = 0.99;
+    double tolerance = 0;          // 0: three noise sigmas
+    size_t threads = std::thread::hardware_concurrency();
+    uint64_t seed = 42;
+    std::string out;
+    bool help = false;             // --help: print the usage and exit
+};
+
+Vec<std::string> splitList(const std::string& text) {
+    Vec<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) if (!item.empty()) items.push_back(item);
+    return items;
+}
+
+Vec<double> numberList(const std::string& text) {
+    Vec<double> numbers;
+    for (const std::string& item : splitList(text)) numbers.push_back(std::stod(item));
+    return numbers;
+}
+
+bool parseDegeneracy(const std::string& name, Degeneracy& degeneracy) {
+    if (name == "none") degeneracy = Degeneracy::None;
+    else if (name == "collinear") degeneracy = Degeneracy::Collinear;
+    else if (name == "duplicates") degeneracy = Degeneracy::Duplicates;
+    else return false;
+    return true;
+}
+
+bool parseArguments(int argc, char** argv, Settings& settings) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        if (key == "--help" || key == "-h") {
+            settings.help = true;
+            return true;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << key << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        try {
+            if (key == "--models") settings.models = splitList(value);
+            else if (key == "--points") settings.points = numberList(value);
+            else if (key == "--outliers") settings.outliers = numberList(value);
+            else if (key == "--noise") settings.noise = numberList(value);
+            else if (key == "--structures") settings.structures = numberList(value);
+            else if (key == "--degeneracy") settings.degeneracies = splitList(value);
+            else if (key == "--variants") settings.variants = splitList(value);
+            else if (key == "--runs") settings.runs = std::max(1, std::stoi(value));
+            else if (key == "--iterations") settings.iterations = std::stoi(value);
+            else if (key == "--min-consensus") settings.min_consensus = std::stoi(value);
+            else if (key == "--confidence") settings.confidence = std::stod(value);
+            else if (key == "--tolerance") settings.tolerance = std::stod(value);
+            else if (key == "--threads") settings.threads = std::max<size_t>(1, std::stoul(value));
+            else if (key == "--seed") settings.seed = std::stoull(value);
+            else if (key == "--out") settings.out = value;
+            else {
+                std::cerr << "Unknown option " << key << std::endl;
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << key << ": " << value << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Nearest-rank percentile of sorted values
+double percentile(const Vec<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+double mean(const Vec<double>& values) {
+    if (values.empty()) return 0;
+    double sum = 0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+constexpr double kDegrees = 180.0 / 3.14159265358979323846;
+
+// Angle in degrees between the directions, and the offset error
+void modelError(const LineModel& found, const LineModel& truth, double& angle, double& offset) {
+    angle = std::abs(std::atan(found.m) - std::atan(truth.m)) * kDegrees;
+    offset = std::abs(found.b - truth.b);
+}
+
+void modelError(const PlaneModel& found, const PlaneModel& truth, double& angle, double& offset) {
+    double cosine = found.normal.dot(truth.normal);
+    angle = std::acos(std::min(1.0, std::abs(cosine))) * kDegrees;
+    offset = std::abs(found.d - (cosine < 0 ? -truth.d : truth.d));
+}
+
+struct Accuracy{
+    Vec<double> angle, offset, precision, recall;
+    int failures = 0;     // runs without a valid model or consensus set
+
+    template <typename Model>
+    void add(const Model& found, const Vec<size_t>& inliers, const SyntheticCloud<Model>& cloud) {
+        if (!found.isValid() || inliers.empty() || cloud.truth.empty()) {
+            failures++;
+            return;
+        }
+        Vec<size_t> votes(cloud.truth.size(), 0);
+        for (size_t i : inliers) if (cloud.label[i] >= 0) votes[cloud.label[i]]++;
+        size_t k = std::max_element(votes.begin(), votes.end()) - votes.begin();
+
+        double a, o;
+        modelError(found, cloud.truth[k], a, o);
+        angle.push_back(a);
+        offset.push_back(o);
+        precision.push_back(static_cast<double>(votes[k]) / inliers.size());
+        recall.push_back(cloud.structure_size[k] ? static_cast<double>(votes[k]) / cloud.structure_size[k] : 0.0);
+    }
+};
+
+// Minimal JSON writer: objects and arrays nest through begin / end, commas are tracked per level
+class Json{
+    public:
+        explicit Json(std::ostream& out) : out(out) { out << std::setprecision(9); }
+
+        void beginObject(const char* key = nullptr) { open(key, '{'); }
+        void endObject() { close('}'); }
+        void beginArray(const char* key = nullptr) { open(key, '['); }
+        void endArray() { close(']'); }
+
+        void field(const char* key, double value) {
+            name(key);
+            if (std::isfinite(value)) out << value;
+            else out << "null";
+        }
+        void field(const char* key, const std::string& value) {
+            name(key);
+            out << '"' << value << '"';
+        }
+
+    private:
+        std::ostream& out;
+        Vec<bool> first{true};
+
+        void name(const char* key) {
+            if (!first.back()) out << ",";
+            first.back() = false;
+            out << "\n" << std::string(2 * (first.size() - 1), ' ');
+            if (key) out << '"' << key << "\": ";
+        }
+        void open(const char* key, char bracket) {
+            if (first.size() > 1 || key) name(key);
+            out << bracket;
+            first.push_back(true);
+        }
+        void close(char bracket) {
+            first.pop_back();
+            out << "\n" << std::string(2 * (first.size() - 1), ' ') << bracket;
+        }
+};
+
+void writeDistribution(Json& json, const char* key, Vec<double> values) {
+    std::sort(values.begin(), values.end());
+    json.beginObject(key);
+    json.field("mean", mean(values));
+    json.field("min", values.empty() ? 0.0 : values.front());
+    json.field("p50", percentile(values, 50));
+    json.field("p90", percentile(values, 90));
+    json.field("p99", percentile(values, 99));
+    json.field("max", values.empty() ? 0.0 : values.back());
+    json.endObject();
+}
+
+template <typename Estimator>
+bool configure(Estimator& solver, const std::string& variant) {
+    if (variant == "plain" || variant == "parallel") return true;
+    if (variant == "batched") solver.enableBatchedScoring();
+    else if (variant == "sprt") solver.enableSPRT();
+    else if (variant == "culling") solver.enableSpatialCulling();
+    else if (variant == "lo") solver.enableLocalOptimization();
+    else if (variant == "msac") solver.setScoring(ScoringMethod::MSAC);
+    else return false;
+    return true;
+}
+
+template <typename Estimator, typename Model>
+void benchVariant(Json& json, const Settings& settings, const SyntheticOptions& options, const std::string& model_name,
+                  const std::string& degeneracy, const std::string& variant, const SyntheticCloud<Model>& cloud,
+                  ThreadPool& pool) {
+    using Clock = std::chrono::steady_clock;
+    const double tolerance = settings.tolerance > 0 ? settings.tolerance
+                           : options.noise > 0 ? 3 * options.noise : 1e-3 * options.extent;
+
+    Estimator solver(cloud.view(), static_cast<typename Estimator::Scalar>(tolerance), settings.iterations,
+                     settings.min_consensus, settings.confidence);
+    if (!configure(solver, variant)) {
+        std::cerr << "Unknown variant " << variant << std::endl;
+        return;
+    }
+
+    Vec<double> latency_ms, iterations;
+    Accuracy accuracy;
+    double total_seconds = 0, total_hypotheses = 0;
+    for (int run = 0; run < settings.runs; run++) {
+        auto start = Clock::now();
+        Model found = variant == "parallel" ? solver.runParallel(pool) : solver.run();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        total_seconds += seconds;
+        total_hypotheses += solver.getIterations();
+        latency_ms.push_back(seconds * 1e3);
+        iterations.push_back(solver.getIterations());
+        accuracy.add(found, solver.getInliers(), cloud);
+    }
+
+    json.beginObject();
+    json.field("model", model_name);
+    json.field("variant", variant);
+    json.field("points", static_cast<double>(cloud.size()));
+    json.field("outlier_ratio", options.outlier_ratio);
+    json.field("noise", options.noise);
+    json.field("structures", static_cast<double>(options.structures));
+    json.field("degeneracy", degeneracy);
+    json.field("tolerance", tolerance);
+    json.field("runs", settings.runs);
+    writeDistribution(json, "latency_ms", latency_ms);
+    writeDistribution(json, "iterations", iterations);
+    json.beginObject("throughput");
+    json.field("hypotheses_per_s", total_hypotheses / total_seconds);
+    json.field("points_scored_per_s", total_hypotheses * cloud.size() / total_seconds);
+    json.endObject();
+    json.beginObject("accuracy");
+    json.field("failures", accuracy.failures);
+    writeDistribution(json, "angle_error_deg", accuracy.angle);
+    writeDistribution(json, "offset_error", accuracy.offset);
+    json.field("precision_mean", mean(accuracy.precision));
+    json.field("recall_mean", mean(accuracy.recall));
+    json.endObject();
+    json.endObject();
+
+    std::sort(latency_ms.begin(), latency_ms.end());
+    std::cerr << model_name << " " << variant << " N=" << cloud.size() << " outliers=" << options.outlier_ratio
+              << " noise=" << options.noise << " structures=" << options.structures << " " << degeneracy
+              << ": p50 " << percentile(latency_ms, 50) << " ms" << std::endl;
+}
+
+template <typename Estimator, typename Model>
+void benchCloud(Json& json, const Settings& settings, const SyntheticOptions& options, const std::string& model_name,
+                const std::string& degeneracy, const SyntheticCloud<Model>& cloud, ThreadPool& pool) {
+    for (const std::string& variant : settings.variants) {
+        benchVariant<Estimator>(json, settings, options, model_name, degeneracy, variant, cloud, pool);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    Settings settings;
+    if (!parseArguments(argc, argv, settings)) {
+        std::cerr << kUsage;
+        return 1;
+    }
+    if (settings.help) {
+        std::cout << kUsage;
+        return 0;
+    }
+
+    std::ofstream file;
+    if (!settings.out.empty()) {
+        file.open(settings.out);
+        if (!file) {
+            std::cerr << "Cannot write " << settings.out << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = settings.out.empty() ? std::cout : file;
+
+    ThreadPool pool(settings.threads);
+    Json json(out);
+    json.beginObject();
+    json.field("benchmark", std::string("ransac_bench"));
+    json.field("seed", static_cast<double>(settings.seed));
+    json.field("threads", static_cast<double>(settings.threads));
+    json.beginArray("results");
+
+    for (const std::string& model : settings.models) {
+        if (model != "line" && model != "plane") {
+            std::cerr << "Unknown model " << model << std::endl;
+            continue;
+        }
+        for (double n : settings.points)
+        for (double outlier_ratio : settings.outliers)
+        for (double noise : settings.noise)
+        for (double structures : settings.structures)
+        for (const std::string& degeneracy : settings.degeneracies) {
+            SyntheticOptions options;
+            options.points = static_cast<size_t>(n);
+            options.outlier_ratio = outlier_ratio;
+            options.noise = noise;
+            options.structures = static_cast<size_t>(structures);
+            options.seed = settings.seed;
+            if (!parseDegeneracy(degeneracy, options.degeneracy)) {
+                std::cerr << "Unknown degeneracy " << degeneracy << std::endl;
+                continue;
+            }
+
+            if (model == "line") benchCloud<LineRANSAC<>>(json, settings, options, model, degeneracy, makeLines(options), pool);
+            else benchCloud<PlaneRANSAC<>>(json, settings, options, model, degeneracy, makePlanes(options), pool);
+        }
+    }
+
+    json.endArray();
+    json.endObject();
+    out << std::endl;
+    return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "../Common.hpp"
+
+// Minimal checks for the behaviour tests: a failed CHECK reports its location and the test
+// exits non-zero once all checks ran
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                                         \
+    do {                                                                                         \
+        if (!(condition)) {                                                                      \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            checkFailures()++;                                                                   \
+        }                                                                                        \
+    } while (0)
+
+inline int checkResult() { return checkFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE; }
+
+// Half the points on z = 0.5 x - 0.2 y + 3 (noise sigma 0.01), half uniform in a 20-unit cube
+inline Vec<Point3d> noisyPlane(size_t n, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> uniform(-10.0, 10.0);
+    std::normal_distribution<double> noise(0.0, 0.01);
+
+    Vec<Point3d> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        double x = uniform(rng), y = uniform(rng);
+        if (i % 2 == 0) points.emplace_back(x, y, 0.5 * x - 0.2 * y + 3 + noise(rng));
+        else points.emplace_back(x, y, uniform(rng));
+    }
+    return points;
+}
+
+// Whether a plane model is z = 0.5 x - 0.2 y + 3 up to tol in every normalized coefficient
+template <typename Model>
+bool isReferencePlane(const Model& plane, double tol = 1e-2) {
+    if (!plane.isValid()) return false;
+    // Reference normal (0.5, -0.2, -1) normalized, d = 3 / |n|, up to sign
+    const double norm = std::sqrt(0.25 + 0.04 + 1.0);
+    const double ref[4] = {0.5 / norm, -0.2 / norm, -1.0 / norm, 3.0 / norm};
+    const double got[4] = {plane.a, plane.b, plane.c, plane.d};
+    double sign = got[2] * ref[2] < 0 ? -1.0 : 1.0;
+    for (int i = 0; i < 4; i++) if (std::abs(sign * got[i] - ref[i]) > tol) return false;
+    return true;
+}
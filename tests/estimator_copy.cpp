@@ -0,0 +1,34 @@
+#include <type_traits>
+#include "../RANSAC_plane.hpp"
+#include "../MultiPlane.hpp"
+#include "../StreamingPlane.hpp"
+#include "../Downsample.hpp"
+#include "Check.hpp"
+
+// An estimator built from a Vec owns its points and views them: a copy must stay valid after
+// the estimator it was copied from is destroyed. Classes whose estimator views their own
+// mutable buffers cannot be copied at all, only moved.
+static_assert(!std::is_copy_constructible<MultiPlaneExtractor<>>::value, "");
+static_assert(std::is_move_constructible<MultiPlaneExtractor<>>::value, "");
+static_assert(!std::is_copy_constructible<StreamingPlaneRANSAC<>>::value, "");
+static_assert(std::is_move_constructible<StreamingPlaneRANSAC<>>::value, "");
+static_assert(!std::is_copy_constructible<DownsampledPlaneRANSAC<>>::value, "");
+static_assert(std::is_move_constructible<DownsampledPlaneRANSAC<>>::value, "");
+
+int main() {
+    PlaneRANSAC<> copied(Vec<Point3d>(), 0.05, 1000, 100);
+    {
+        PlaneRANSAC<> source(noisyPlane(20000, 3), 0.05, 1000, 100);
+        CHECK(isReferencePlane(source.run()));
+        copied = source;
+    }
+    CHECK(isReferencePlane(copied.run()));
+    CHECK(copied.getInliers().size() > 9000);
+
+    PlaneRANSAC<> constructed = [] {
+        PlaneRANSAC<> local(noisyPlane(20000, 5), 0.05, 1000, 100);
+        return PlaneRANSAC<>(local);
+    }();
+    CHECK(isReferencePlane(constructed.run()));
+    return checkResult();
+}
@@ -0,0 +1,57 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "../PointCloudIO.hpp"
+#include "Check.hpp"
+
+// Malformed or oversized numbers in a PCD or PLY header are load failures, not exceptions or
+// views past the end of the file
+static bool loads(const std::string &extension, const std::string &header, const std::string &body) {
+    const std::string path = "pcd_header_test" + extension;
+    std::ofstream(path, std::ios::binary) << header << body;
+    PointCloud cloud;
+    bool ok = cloud.load(path);
+    bool sized = !ok || cloud.size() == 2;
+    std::remove(path.c_str());
+    return ok && sized;
+}
+
+// Two float32 records of x y z w, 16 bytes each
+static std::string binaryRecords() {
+    const float values[8] = {1, 2, 3, 0, 4, 5, 6, 0};
+    return std::string(reinterpret_cast<const char*>(values), sizeof(values));
+}
+
+int main() {
+    const std::string ascii = "DATA ascii\n1 2 3\n4 5 6\n";
+    auto pcd = [](const std::string &size, const std::string &count, const std::string &points,
+                  const std::string &fields = "x y z", const std::string &types = "F F F") {
+        return "VERSION .7\nFIELDS " + fields + "\nSIZE " + size + "\nTYPE " + types + "\nCOUNT " + count +
+               "\nWIDTH 2\nHEIGHT 1\nPOINTS " + points + "\n";
+    };
+    auto ply = [](const std::string &format, const std::string &vertices) {
+        return "ply\nformat " + format + " 1.0\nelement vertex " + vertices +
+               "\nproperty float x\nproperty float y\nproperty float z\nproperty float w\nend_header\n";
+    };
+
+    CHECK(loads(".pcd", pcd("4 4 4", "1 1 1", "2"), ascii));
+    CHECK(!loads(".pcd", pcd("4 four 4", "1 1 1", "2"), ascii));
+    CHECK(!loads(".pcd", pcd("4 4 4", "1 1x 1", "2"), ascii));
+    CHECK(!loads(".pcd", pcd("4 4 4", "1 1 99999999999999999999999", "2"), ascii));
+    CHECK(!loads(".pcd", pcd("4 4 4", "1 1 1", "-2"), ascii));
+    CHECK(!loads(".pcd", pcd("0 4 4", "1 1 1", "2"), ascii));
+    CHECK(!loads(".pcd", pcd("4 4 4", "1 1 1", "3"), ascii));
+    CHECK(!loads(".pcd", pcd("4 4 4", "1 1 1", "1000000000000"), ascii));
+
+    const std::string binary_pcd = "4 4 4 4";
+    CHECK(loads(".pcd", pcd(binary_pcd, "1 1 1 1", "2", "x y z w", "F F F F"), "DATA binary\n" + binaryRecords()));
+    CHECK(!loads(".pcd", pcd(binary_pcd, "1 1 1 1", "4611686018427387904", "x y z w", "F F F F"),
+                 "DATA binary\n" + binaryRecords()));
+
+    CHECK(loads(".ply", ply("binary_little_endian", "2"), binaryRecords()));
+    CHECK(!loads(".ply", ply("binary_little_endian", "4611686018427387904"), binaryRecords()));
+    CHECK(!loads(".ply", ply("binary_little_endian", "2x"), binaryRecords()));
+    CHECK(!loads(".ply", ply("ascii", "two"), "1 2 3 0\n4 5 6 0\n"));
+    CHECK(loads(".ply", ply("ascii", "2"), "1 2 3 0\n4 5 6 0\n"));
+    return checkResult();
+}
@@ -0,0 +1,35 @@
+#include <random>
+#include "../RANSAC_plane.hpp"
+#include "Check.hpp"
+
+// A 2D view (null z, read as 0) is a valid plane input: every scoring path must treat z as 0
+// rather than read through the null pointer, and find the plane z = 0 with every point on it
+template <typename Scalar>
+static bool findsGroundPlane(const PointView& view, int variant) {
+    PlaneRANSAC<Scalar> solver(view, Scalar(0.01), 200, 100);
+    if (variant == 1) solver.enableBatchedScoring(16);
+    if (variant == 2) solver.enableSpatialCulling();
+    if (variant == 3) solver.enableSPRT();
+    auto plane = solver.run();
+    return plane.isValid() && std::abs(std::abs(plane.c) - 1) < 1e-6 && std::abs(plane.d) < 1e-6 &&
+           solver.getInliers().size() == view.size();
+}
+
+int main() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> uniform(-10.0, 10.0);
+    Vec<Pair<double, double>> pairs(1000);
+    Vec<Pair<float, float>> pairs_f(pairs.size());
+    for (size_t i = 0; i < pairs.size(); i++) {
+        double x = uniform(rng);
+        double y = uniform(rng);
+        pairs[i] = {x, y};
+        pairs_f[i] = {static_cast<float>(x), static_cast<float>(y)};
+    }
+
+    for (int variant = 0; variant < 4; variant++) {
+        CHECK(findsGroundPlane<double>(PointView::of(pairs), variant));
+        CHECK(findsGroundPlane<float>(PointView::of(pairs_f), variant));
+    }
+    return checkResult();
+}
@@ -0,0 +1,27 @@
+#include "../RANSAC_plane.hpp"
+#include "Check.hpp"
+
+// runPreemptive() must not shrink the buffers batched scoring packs hypotheses into: batched
+// run(), then a preemptive run that ends with one survivor, then batched run() again
+int main() {
+    Vec<Point3d> points = noisyPlane(20000, 7);
+    PlaneRANSAC<> solver(points, 0.05, 1000, 100);
+    solver.enableBatchedScoring(64);
+
+    CHECK(isReferencePlane(solver.run()));
+
+    PreemptiveOptions options;
+    options.hypotheses = 128;
+    options.block_size = 50;
+    options.refine = true;
+    CHECK(isReferencePlane(solver.runPreemptive(options)));
+    CHECK(solver.getPreemptiveReport().survivors == 1);
+
+    CHECK(isReferencePlane(solver.run()));
+    CHECK(solver.getInliers().size() > 9000);
+
+    // No hypotheses is an error, not an empty run
+    options.hypotheses = 0;
+    CHECK(!solver.runPreemptive(options).isValid());
+    return checkResult();
+}
@@ -0,0 +1,20 @@
+#include "../Downsample.hpp"
+#include "Check.hpp"
+
+// Local optimization on a weighted run compares candidates by the same (negated weighted loss)
+// quality the scored loop keeps, so a refit cannot lock in a best no hypothesis can beat
+int main() {
+    Vec<Point3d> points = noisyPlane(50000, 11);
+
+    for (bool lo : {false, true}) {
+        int found = 0;
+        const int trials = 20;
+        for (int trial = 0; trial < trials; trial++) {
+            DownsampledPlaneRANSAC<> ransac(0.05, 0.05, 1000, 1000);
+            if (lo) ransac.estimator().enableLocalOptimization();
+            if (isReferencePlane(ransac.run(PointView::of(points)))) found++;
+        }
+        CHECK(found == trials);
+    }
+    return checkResult();
+}